@@ -0,0 +1,123 @@
+#include "assets.h"
+
+#include <algorithm>
+
+AssetLoader::~AssetLoader() {
+    join();
+}
+
+void AssetLoader::join() {
+    for (std::thread& worker : workers) {
+        if (worker.joinable()) {
+            worker.join();
+        }
+    }
+    workers.clear();
+}
+
+bool AssetLoader::start(const char* bundlePath, GameAssets& assets) {
+    clock.restart();
+    if (bundlePath != nullptr) {
+        bundle.open(bundlePath);
+    }
+
+    // The font is small and the menu needs it for its first frame
+    bool fontLoaded;
+    if (bundle.isOpen()) {
+        std::size_t size;
+        const void* data = bundle.find("alien.ttf", size);
+        fontLoaded = data != nullptr && assets.font.loadFromMemory(data, size);
+    }
+    else {
+        fontLoaded = assets.font.loadFromFile("alien.ttf");
+    }
+    if (!fontLoaded) {
+        failure = true;
+        return false;
+    }
+
+    tasks = {
+        { "background.png", &backgroundImage, nullptr, false },
+        { "player.png", &playerImage, nullptr, false },
+        { "enemy.png", &enemyImage, nullptr, false },
+        { "shoot.mp3", nullptr, &assets.shootBuffer, false },
+        { "hit.mp3", nullptr, &assets.hitBuffer, false },
+    };
+    remaining = (int)tasks.size();
+
+    unsigned threads = std::max(1u, std::min(std::thread::hardware_concurrency(), (unsigned)tasks.size()));
+    for (unsigned i = 0; i < threads; ++i) {
+        workers.emplace_back(&AssetLoader::work, this);
+    }
+    return true;
+}
+
+void AssetLoader::work() {
+    for (int i = nextTask++; i < (int)tasks.size(); i = nextTask++) {
+        runTask(tasks[i]);
+        --remaining;
+    }
+}
+
+void AssetLoader::runTask(Task& task) {
+    if (bundle.isOpen()) {
+        std::size_t size;
+        const void* data = bundle.find(task.name, size);
+        if (data == nullptr) {
+            task.ok = false;
+        }
+        else if (task.image != nullptr) {
+            task.ok = task.image->loadFromMemory(data, size);
+        }
+        else {
+            task.ok = task.sound->loadFromMemory(data, size);
+        }
+    }
+    else if (task.image != nullptr) {
+        task.ok = task.image->loadFromFile(task.name);
+    }
+    else {
+        task.ok = task.sound->loadFromFile(task.name);
+    }
+}
+
+bool AssetLoader::poll(GameAssets& assets) {
+    if (finished || failure) {
+        return finished;
+    }
+    if (remaining > 0) {
+        return false;
+    }
+    join();
+
+    for (const Task& task : tasks) {
+        failure = failure || !task.ok;
+    }
+    if (failure ||
+        !assets.playerTexture.loadFromImage(playerImage) ||
+        !assets.enemyTexture.loadFromImage(enemyImage) ||
+        !assets.backgroundTexture.loadFromImage(backgroundImage)) {
+        failure = true;
+        return false;
+    }
+    // The collision mask is taken from the decoded pixels before they go
+    buildSpriteMask(enemyImage.getPixelsPtr(), (int)enemyImage.getSize().x, (int)enemyImage.getSize().y,
+                    assets.enemyMask);
+    playerImage = sf::Image();
+    enemyImage = sf::Image();
+    backgroundImage = sf::Image();
+
+    // Music is optional
+    if (bundle.isOpen()) {
+        std::size_t size;
+        const void* data = bundle.find("music.mp3", size);
+        assets.hasMusic = data != nullptr && assets.music.openFromMemory(data, size);
+    }
+    else {
+        assets.hasMusic = assets.music.openFromFile("music.mp3");
+    }
+
+    loadTime = clock.getElapsedTime().asSeconds();
+    finished = true;
+    return true;
+}
@@ -0,0 +1,69 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+#include <SFML/Graphics.hpp>
+
+#include <atomic>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "bundle.h"
+#include "mask.h"
+
+// Everything the game loads at startup
+struct GameAssets {
+    sf::Texture playerTexture, enemyTexture, backgroundTexture;
+    sf::Font font;
+    sf::SoundBuffer shootBuffer, hitBuffer;
+    sf::Music music;
+    bool hasMusic = false;
+    SpriteMask enemyMask; // solid pixels of enemy.png, for collisions
+};
+
+// Loads GameAssets from the packed bundle when it exists, or from loose
+// files otherwise. The font is loaded up front so the menu can render at
+// once; images and sounds are decoded on worker threads meanwhile, and
+// poll() finishes the job on the main thread (texture upload needs the
+// window's GL context). Music streams straight from the mapped bundle,
+// so the loader must outlive the assets.
+class AssetLoader {
+public:
+    AssetLoader() = default;
+    ~AssetLoader();
+
+    AssetLoader(const AssetLoader&) = delete;
+    AssetLoader& operator=(const AssetLoader&) = delete;
+
+    // Returns false if the font can't be loaded
+    bool start(const char* bundlePath, GameAssets& assets);
+
+    // True once every asset is ready; call once per frame
+    bool poll(GameAssets& assets);
+    bool failed() const { return failure; }
+    bool usingBundle() const { return bundle.isOpen(); }
+    float loadSeconds() const { return loadTime; }
+
+private:
+    struct Task {
+        std::string name;
+        sf::Image* image;
+        sf::SoundBuffer* sound;
+        bool ok;
+    };
+
+    void work();
+    void runTask(Task& task);
+    void join();
+
+    AssetBundle bundle;
+    sf::Image playerImage, enemyImage, backgroundImage;
+    std::vector<Task> tasks;
+    std::vector<std::thread> workers;
+    std::atomic<int> nextTask{ 0 };
+    std::atomic<int> remaining{ 0 };
+    bool finished = false;
+    bool failure = false;
+    sf::Clock clock;
+    float loadTime = 0.0f;
+};
@@ -0,0 +1,100 @@
+#include "audio.h"
+
+VoicePool::VoicePool(int voiceCount) : voices(voiceCount) {
+}
+
+int VoicePool::addEffect(const sf::SoundBuffer& buffer, int maxVoices, int priority) {
+    // Adding the same buffer twice returns the existing effect
+    for (size_t i = 0; i < effects.size(); ++i) {
+        if (effects[i].buffer == &buffer) {
+            return (int)i;
+        }
+    }
+    effects.push_back({ &buffer, maxVoices, priority, false });
+    return (int)effects.size() - 1;
+}
+
+void VoicePool::trigger(int effect) {
+    effects[effect].pending = true;
+}
+
+void VoicePool::drain() {
+    for (size_t i = 0; i < effects.size(); ++i) {
+        if (effects[i].pending) {
+            effects[i].pending = false;
+            start((int)i);
+        }
+    }
+}
+
+void VoicePool::stopAll() {
+    for (size_t i = 0; i < effects.size(); ++i) {
+        effects[i].pending = false;
+    }
+    for (size_t v = 0; v < voices.size(); ++v) {
+        voices[v].sound.stop();
+        voices[v].effect = -1;
+    }
+}
+
+int VoicePool::findVoice(int effect) {
+    int playing = 0, oldestOwn = -1, freeVoice = -1, victim = -1;
+
+    for (size_t v = 0; v < voices.size(); ++v) {
+        Voice& voice = voices[v];
+        if (voice.effect == -1 || voice.sound.getStatus() == sf::Sound::Stopped) {
+            voice.effect = -1;
+            if (freeVoice == -1) {
+                freeVoice = (int)v;
+            }
+            continue;
+        }
+
+        if (voice.effect == effect) {
+            ++playing;
+            if (oldestOwn == -1 || voice.startedAt < voices[oldestOwn].startedAt) {
+                oldestOwn = (int)v;
+            }
+        }
+
+        // Steal candidates: lowest priority first, then oldest
+        int priority = effects[voice.effect].priority;
+        if (priority <= effects[effect].priority) {
+            if (victim == -1) {
+                victim = (int)v;
+            }
+            else {
+                int victimPriority = effects[voices[victim].effect].priority;
+                if (priority < victimPriority ||
+                    (priority == victimPriority && voice.startedAt < voices[victim].startedAt)) {
+                    victim = (int)v;
+                }
+            }
+        }
+    }
+
+    if (playing >= effects[effect].maxVoices) {
+        return oldestOwn;
+    }
+    if (freeVoice != -1) {
+        return freeVoice;
+    }
+    return victim;
+}
+
+void VoicePool::start(int effect) {
+    int v = findVoice(effect);
+    if (v == -1) {
+        return; // Every voice is busy with something more important
+    }
+
+    Voice& voice = voices[v];
+    voice.sound.stop();
+    if (voice.loaded != effect) {
+        voice.sound.setBuffer(*effects[effect].buffer);
+        voice.loaded = effect;
+    }
+    voice.effect = effect;
+    voice.startedAt = ++serial;
+    voice.sound.play();
+}
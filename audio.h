@@ -0,0 +1,49 @@
+#pragma once
+
+#include <SFML/Audio.hpp>
+
+#include <vector>
+
+// Preallocated pool of sf::Sound voices shared by all sound effects. The
+// game triggers effects while it steps the simulation; triggers are only
+// recorded, so repeats of one effect within a drain collapse into one,
+// and drain() starts the sounds once per frame, outside the update.
+// Each effect has a voice limit and a priority: an effect at its limit
+// restarts its own oldest voice, and when every voice is busy a new sound
+// takes the oldest voice of the lowest priority not above its own.
+
+class VoicePool {
+public:
+    explicit VoicePool(int voiceCount);
+
+    // Registers an effect for `buffer`; returns its id
+    int addEffect(const sf::SoundBuffer& buffer, int maxVoices, int priority);
+
+    void trigger(int effect);
+    void drain();
+
+    // Drop all pending triggers and silence every voice
+    void stopAll();
+
+private:
+    struct Effect {
+        const sf::SoundBuffer* buffer;
+        int maxVoices;
+        int priority;
+        bool pending;
+    };
+
+    struct Voice {
+        sf::Sound sound;
+        int effect = -1; // playing effect, -1 when free
+        int loaded = -1; // effect whose buffer is attached
+        unsigned long startedAt = 0;
+    };
+
+    void start(int effect);
+    int findVoice(int effect);
+
+    std::vector<Effect> effects;
+    std::vector<Voice> voices;
+    unsigned long serial = 0;
+};
@@ -0,0 +1,141 @@
+#include "bench.h"
+
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+
+static long long allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+long long benchAllocationCount() {
+    return allocationCount;
+}
+
+struct BenchEntry {
+    std::string name;
+    BenchFunction function;
+    std::vector<long long> args;
+};
+
+static std::vector<BenchEntry>& registry() {
+    static std::vector<BenchEntry> entries;
+    return entries;
+}
+
+BenchRegistration::BenchRegistration(const char* name, BenchFunction function, std::initializer_list<long long> args) {
+    registry().push_back({ name, function, args });
+}
+
+BenchState::BenchState(long long range, double minSeconds) : arg(range), minSeconds(minSeconds) {
+}
+
+bool BenchState::keepRunning() {
+    if (!running && done == 0) {
+        running = true;
+        allocationsAtStart = allocationCount;
+        started = Clock::now();
+        return true;
+    }
+
+    ++done;
+    // Only read the clock on a doubling schedule so tiny bodies aren't swamped
+    if (done < nextCheck) {
+        return true;
+    }
+    nextCheck = done * 2;
+
+    double total = elapsed + std::chrono::duration<double>(Clock::now() - started).count();
+    if (total < minSeconds) {
+        return true;
+    }
+    elapsed = total;
+    allocated += allocationCount - allocationsAtStart;
+    running = false;
+    return false;
+}
+
+void BenchState::pauseTiming() {
+    elapsed += std::chrono::duration<double>(Clock::now() - started).count();
+    allocated += allocationCount - allocationsAtStart;
+}
+
+void BenchState::resumeTiming() {
+    allocationsAtStart = allocationCount;
+    started = Clock::now();
+}
+
+int runBenchmarks(int argc, char** argv) {
+    const char* filter = nullptr;
+    double minSeconds = 0.2;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--filter") == 0 && i + 1 < argc) {
+            filter = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--min-time") == 0 && i + 1 < argc) {
+            minSeconds = std::atof(argv[++i]);
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--filter SUBSTRING] [--min-time SECONDS]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::printf("%-44s %12s %14s %12s %12s\n", "benchmark", "iterations", "ns/iter", "ns/item", "allocs/iter");
+    for (const BenchEntry& entry : registry()) {
+        for (long long arg : entry.args) {
+            std::string name = entry.name + "/" + std::to_string(arg);
+            if (filter != nullptr && name.find(filter) == std::string::npos) {
+                continue;
+            }
+
+            BenchState state(arg, minSeconds);
+            entry.function(state);
+
+            long long iterations = state.iterations() > 0 ? state.iterations() : 1;
+            double nsPerIteration = state.seconds() * 1e9 / iterations;
+            double allocsPerIteration = (double)state.allocations() / iterations;
+            char perItem[32] = "-";
+            if (state.items() > 0) {
+                std::snprintf(perItem, sizeof(perItem), "%.2f", nsPerIteration / state.items());
+            }
+            std::printf("%-44s %12lld %14.1f %12s %12.2f\n", name.c_str(), state.iterations(),
+                        nsPerIteration, perItem, allocsPerIteration);
+            std::fflush(stdout);
+        }
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    return runBenchmarks(argc, argv);
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <initializer_list>
+#include <vector>
+
+// Small Google-Benchmark style harness. A benchmark is a function taking a
+// BenchState; it loops on keepRunning() and is run once per argument.
+// Heap allocations made while timing are counted through a replaced
+// global operator new and reported per iteration.
+//
+//     static void BM_Thing(BenchState& state) {
+//         Setup setup(state.range());
+//         while (state.keepRunning()) {
+//             doThing(setup);
+//         }
+//         state.setItemsProcessed(state.range());
+//     }
+//     BENCHMARK(BM_Thing, 100, 1000, 10000);
+
+class BenchState {
+public:
+    BenchState(long long range, double minSeconds);
+
+    long long range() const { return arg; }
+    bool keepRunning();
+
+    // Exclude per-iteration setup from the measurement
+    void pauseTiming();
+    void resumeTiming();
+
+    // Items handled by one iteration, used for the ns/item column
+    void setItemsProcessed(long long items) { itemsPerIteration = items; }
+
+    long long iterations() const { return done; }
+    double seconds() const { return elapsed; }
+    long long items() const { return itemsPerIteration; }
+    long long allocations() const { return allocated; }
+
+private:
+    typedef std::chrono::steady_clock Clock;
+
+    long long arg;
+    double minSeconds;
+    long long done = 0;
+    long long nextCheck = 1;
+    long long itemsPerIteration = 0;
+    double elapsed = 0;
+    long long allocated = 0;
+    long long allocationsAtStart = 0;
+    bool running = false;
+    Clock::time_point started;
+};
+
+typedef void (*BenchFunction)(BenchState&);
+
+struct BenchRegistration {
+    BenchRegistration(const char* name, BenchFunction function, std::initializer_list<long long> args);
+};
+
+#define BENCHMARK(function, ...) \
+    static BenchRegistration function##_registration(#function, function, { __VA_ARGS__ })
+
+// Keeps the optimizer from discarding a computed value
+template <typename T>
+inline void doNotOptimize(const T& value) {
+    asm volatile("" : : "r,m"(value) : "memory");
+}
+
+// Heap allocations made by the process so far
+long long benchAllocationCount();
+
+int runBenchmarks(int argc, char** argv);
@@ -0,0 +1,222 @@
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+
+#include "bench.h"
+#include "../mask.h"
+#include "../world.h"
+
+// Broadphase against the brute-force pairwise test it replaced. Half of the
+// entities are bullets and half are enemies, scattered over the playfield.
+// Both sides do collision work only: the worlds here have no debris
+// storage, so a hit spawns no explosion (BM_SpawnExplosion in
+// particles_bench.cpp times that on its own).
+
+static bool overlaps(float ax, float ay, float aw, float ah, float bx, float by, float bw, float bh) {
+    return std::max(ax, bx) < std::min(ax + aw, bx + bw) && std::max(ay, by) < std::min(ay + ah, by + bh);
+}
+
+struct Bullet {
+    float x, y;
+};
+
+struct Enemy {
+    float x, y;
+};
+
+struct BruteForceWorld {
+    std::vector<Bullet> bullets;
+    std::vector<Enemy> enemies;
+    float enemyWidth = DEFAULT_ENEMY_WIDTH, enemyHeight = DEFAULT_ENEMY_HEIGHT;
+    int score = 0;
+};
+
+// The previous implementation: every bullet against every enemy, erasing hits
+static int bruteForceCollisions(BruteForceWorld& world) {
+    std::vector<Bullet>& bullets = world.bullets;
+    std::vector<Enemy>& enemies = world.enemies;
+    int hits = 0;
+
+    for (size_t i = 0; i < bullets.size();) {
+        bool hit = false;
+        for (size_t j = 0; j < enemies.size();) {
+            if (overlaps(bullets[i].x, bullets[i].y, BULLET_WIDTH, BULLET_HEIGHT,
+                         enemies[j].x, enemies[j].y, world.enemyWidth, world.enemyHeight)) {
+                bullets.erase(bullets.begin() + i);
+                enemies.erase(enemies.begin() + j);
+                world.score += 10;
+                ++hits;
+                hit = true;
+                break;
+            }
+            else {
+                ++j;
+            }
+        }
+        if (!hit) {
+            ++i;
+        }
+    }
+    return hits;
+}
+
+static void makeScatteredWorlds(long long entities, World& world, BruteForceWorld& reference) {
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> xs(0.0f, WINDOW_WIDTH - DEFAULT_ENEMY_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, WINDOW_HEIGHT - DEFAULT_ENEMY_HEIGHT);
+
+    world.enemies.reserve(entities / 2);
+    world.bullets.reserve(entities / 2);
+    for (long long i = 0; i < entities / 2; ++i) {
+        float ex = xs(rng), ey = ys(rng), bx = xs(rng), by = ys(rng);
+        world.enemies.add(ex, ey, DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT);
+        world.bullets.add(bx, by, BULLET_WIDTH, BULLET_HEIGHT);
+        reference.enemies.push_back({ ex, ey });
+        reference.bullets.push_back({ bx, by });
+    }
+    world.enemyGrid.reset(world.enemies.size());
+    for (size_t j = 0; j < world.enemies.size(); ++j) {
+        world.enemyGrid.update((int)j, world.enemies.x[j], world.enemies.y[j]);
+    }
+    if (world.debris.capacity != 0) {
+        std::fprintf(stderr, "collision benchmark world has debris storage\n");
+        std::abort();
+    }
+
+    // Both paths must agree before their timings mean anything
+    World a = world;
+    BruteForceWorld b = reference;
+    if (checkBulletEnemyCollisions<ClassicTuning>(a) != bruteForceCollisions(b) || a.enemies.size() != b.enemies.size()) {
+        std::fprintf(stderr, "broadphase disagrees with brute force at %lld entities\n", entities);
+        std::abort();
+    }
+}
+
+static void BM_CollisionsBruteForce(BenchState& state) {
+    World unused;
+    BruteForceWorld base;
+    makeScatteredWorlds(state.range(), unused, base);
+    BruteForceWorld world;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        world = base;
+        state.resumeTiming();
+        doNotOptimize(bruteForceCollisions(world));
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_CollisionsBruteForce, 10, 30, 100, 300, 1000, 3000, 10000);
+
+static void BM_CollisionsGrid(BenchState& state) {
+    World base;
+    BruteForceWorld unused;
+    makeScatteredWorlds(state.range(), base, unused);
+    World world;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        world = base;
+        state.resumeTiming();
+        doNotOptimize(checkBulletEnemyCollisions<ClassicTuning>(world));
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_CollisionsGrid, 10, 30, 100, 300, 1000, 3000, 10000);
+
+// enemy.png's solid pixels, as buildSpriteMask keys them out of its white
+// background
+static const char* const ENEMY_SILHOUETTE[] = {
+    "........ooooooo....................ooooooo........",
+    "........ooooooo....................ooooooo........",
+    "........ooooooo....................ooooooo........",
+    "........oooooooooo...............ooooooooo........",
+    "........ooooooooooo............ooooooooooo........",
+    "..........ooooooooo............oooooooooo.........",
+    ".............oooooo............ooooooo............",
+    "...........ooooooooo.........oooooooooo...........",
+    ".........oooooooooooooooooooooooooooooooo.........",
+    "........oooooooooooooooooooooooooooooooooo........",
+    "........oooooooooooooooooooooooooooooooooo........",
+    "........ooooooooooooooooooooooooooooooooooo.......",
+    "......ooooooooooooooooooooooooooooooooooooo.......",
+    "....oooooooooooooooooooooooooooooooooooooooooo....",
+    "...ooooooooooooooooooooooooooooooooooooooooooo....",
+    "...oooooooooooo..oooooooooooooooo..oooooooooooo...",
+    "...oooooooooooo..oooooooooooooooo..oooooooooooo...",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooooooooooooooooooooooooooooooooooooooooooooooo",
+    "oooooo..ooooooooooooooooooooooooooooooooooo.oooooo",
+    "oooooo..oooooooooooooooooooooooooooooooooo..oooooo",
+    "oooooo..oooooooooooooooooooooooooooooooooo..oooooo",
+    "oooooo..oooooooooooooooooooooooooooooooooo..oooooo",
+    "oooooo..ooooooo....................ooooooo..oooooo",
+    "oooooo..ooooooo....................ooooooo..oooooo",
+    "oooooo..oooooooooooo.oo.....oooooooooooooo..oooooo",
+    "ooooo...oooooooooooooooo..oooooooooooooooo..oooooo",
+    "ooo........ooooooooooooo..oooooooooooooo.......ooo",
+    ".............ooooooooooo..ooooooooooo.............",
+    ".............ooooooooooo..ooooooooooo.............",
+    ".............ooooooooooo..ooooooooooo.............",
+};
+
+static SpriteMask makeEnemyMask() {
+    const int width = 50, height = 36;
+    std::vector<std::uint8_t> rgba(width * height * 4, 0);
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            if (ENEMY_SILHOUETTE[y][x] == 'o') {
+                rgba[(y * width + x) * 4 + 3] = 255;
+            }
+        }
+    }
+    SpriteMask mask;
+    buildSpriteMask(rgba.data(), width, height, mask);
+    return mask;
+}
+
+// Cost of the narrowphase per pair the AABB test has already accepted:
+// bullets placed anywhere they touch the enemy's box
+static void BM_MaskNarrowphase(BenchState& state) {
+    SpriteMask mask = makeEnemyMask();
+    std::mt19937 rng(1234);
+    std::uniform_real_distribution<float> xs(-BULLET_WIDTH + 0.5f, DEFAULT_ENEMY_WIDTH - 0.5f);
+    std::uniform_real_distribution<float> ys(-BULLET_HEIGHT + 0.5f, DEFAULT_ENEMY_HEIGHT - 0.5f);
+    std::vector<float> bx(state.range()), by(state.range());
+    for (long long i = 0; i < state.range(); ++i) {
+        bx[i] = xs(rng);
+        by[i] = ys(rng);
+    }
+    while (state.keepRunning()) {
+        int hits = 0;
+        for (long long i = 0; i < state.range(); ++i) {
+            hits += maskOverlapsRect(mask, 0.0f, 0.0f, DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT,
+                                     bx[i], by[i], BULLET_WIDTH, BULLET_HEIGHT);
+        }
+        doNotOptimize(hits);
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_MaskNarrowphase, 1000);
+
+static void BM_CollisionsGridMasked(BenchState& state) {
+    SpriteMask mask = makeEnemyMask();
+    World base;
+    BruteForceWorld unused;
+    makeScatteredWorlds(state.range(), base, unused);
+    base.enemyMask = &mask;
+    World world;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        world = base;
+        state.resumeTiming();
+        doNotOptimize(checkBulletEnemyCollisions<ClassicTuning>(world));
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_CollisionsGridMasked, 10, 30, 100, 300, 1000, 3000, 10000);
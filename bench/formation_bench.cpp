@@ -0,0 +1,77 @@
+#include <random>
+
+#include "bench.h"
+#include "../formation.h"
+#include "../world.h"
+
+// Enemy formation movement: the per-enemy loop it replaced against each
+// formation kernel, at sizes from the default 32-enemy grid up to 100k.
+
+// The previous implementation: test each enemy against the edges as it
+// moves, then walk the whole formation again to step it down
+static void previousUpdateEnemies(World& world, float dt) {
+    EntityArrays& enemies = world.enemies;
+    float moveDistance = world.enemySpeed * dt * world.enemyDirection;
+
+    for (size_t i = 0; i < enemies.size(); ++i) {
+        enemies.x[i] += moveDistance;
+
+        if (enemies.x[i] <= 0 || enemies.x[i] >= WINDOW_WIDTH - enemies.w[i]) {
+            world.enemyDirection *= -1;
+            for (size_t j = 0; j < enemies.size(); ++j) {
+                enemies.y[j] += 10;
+            }
+            break;
+        }
+    }
+}
+
+static World makeFormation(long long count) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> xs(100.0f, WINDOW_WIDTH - 100.0f - DEFAULT_ENEMY_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, 200.0f);
+
+    World world;
+    world.enemies.reserve(count);
+    for (long long i = 0; i < count; ++i) {
+        world.enemies.add(xs(rng), ys(rng), DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT);
+    }
+    return world;
+}
+
+static void BM_UpdateEnemiesPrevious(BenchState& state) {
+    World world = makeFormation(state.range());
+    while (state.keepRunning()) {
+        previousUpdateEnemies(world, TICK_DT);
+    }
+    doNotOptimize(world.enemies.y[0]);
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_UpdateEnemiesPrevious, 32, 1000, 10000, 100000);
+
+static void runKernel(BenchState& state, FormationKernel kernel) {
+    FormationKernel saved = activeFormationKernel();
+    setFormationKernel(kernel);
+    World world = makeFormation(state.range());
+    while (state.keepRunning()) {
+        updateEnemies<ClassicTuning>(world, TICK_DT);
+    }
+    doNotOptimize(world.enemies.y[0]);
+    state.setItemsProcessed(state.range());
+    setFormationKernel(saved);
+}
+
+static void BM_UpdateEnemiesScalar(BenchState& state) {
+    runKernel(state, FormationKernel::Scalar);
+}
+BENCHMARK(BM_UpdateEnemiesScalar, 32, 1000, 10000, 100000);
+
+static void BM_UpdateEnemiesSSE(BenchState& state) {
+    runKernel(state, FormationKernel::SSE);
+}
+BENCHMARK(BM_UpdateEnemiesSSE, 32, 1000, 10000, 100000);
+
+static void BM_UpdateEnemiesAVX2(BenchState& state) {
+    runKernel(state, FormationKernel::AVX2);
+}
+BENCHMARK(BM_UpdateEnemiesAVX2, 32, 1000, 10000, 100000);
@@ -0,0 +1,117 @@
+#include <random>
+
+#include "bench.h"
+#include "../world.h"
+
+// One benchmark per gameplay function, swept over entity counts. Worlds
+// are rebuilt outside the timed region so every iteration sees the same
+// input.
+
+static World makeWorld(long long enemies, long long bullets) {
+    std::mt19937 rng(4321);
+    std::uniform_real_distribution<float> xs(0.0f, WINDOW_WIDTH - DEFAULT_ENEMY_WIDTH);
+    std::uniform_real_distribution<float> enemyYs(0.0f, WINDOW_HEIGHT / 2);
+    std::uniform_real_distribution<float> bulletYs(0.0f, (float)WINDOW_HEIGHT);
+
+    World world;
+    world.enemies.reserve(enemies);
+    world.bullets.reserve(bullets);
+    for (long long i = 0; i < enemies; ++i) {
+        world.enemies.add(xs(rng), enemyYs(rng), DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT);
+    }
+    for (long long i = 0; i < bullets; ++i) {
+        world.bullets.add(xs(rng), bulletYs(rng), BULLET_WIDTH, BULLET_HEIGHT);
+    }
+    world.enemyGrid.reset(world.enemies.size());
+    for (size_t j = 0; j < world.enemies.size(); ++j) {
+        world.enemyGrid.update((int)j, world.enemies.x[j], world.enemies.y[j]);
+    }
+    return world;
+}
+
+static void BM_UpdateBullets(BenchState& state) {
+    World base = makeWorld(0, state.range());
+    World world = base;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        world.bullets = base.bullets;
+        state.resumeTiming();
+        updateBullets<ClassicTuning>(world.bullets, TICK_DT);
+    }
+    doNotOptimize(world.bullets.size());
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_UpdateBullets, 100, 1000, 10000, 100000);
+
+static void BM_UpdateEnemies(BenchState& state) {
+    World world = makeWorld(state.range(), 0);
+    while (state.keepRunning()) {
+        updateEnemies<ClassicTuning>(world, TICK_DT);
+    }
+    doNotOptimize(world.enemies.y[0]);
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_UpdateEnemies, 100, 1000, 10000, 100000);
+
+// Sparse fire into a dense formation, closer to play than the scatter in
+// collision_bench.cpp: one bullet per ten enemies. No debris storage, so
+// only the collision work is timed.
+static void BM_CheckBulletEnemyCollisions(BenchState& state) {
+    World base = makeWorld(state.range(), state.range() / 10);
+    World world = base;
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        world.bullets = base.bullets;
+        world.enemies = base.enemies;
+        world.enemyGrid = base.enemyGrid;
+        state.resumeTiming();
+        doNotOptimize(checkBulletEnemyCollisions<ClassicTuning>(world));
+    }
+    state.setItemsProcessed(state.range() + state.range() / 10);
+}
+BENCHMARK(BM_CheckBulletEnemyCollisions, 100, 1000, 10000, 100000);
+
+// Game-over check while nobody has landed yet, so every enemy is scanned
+static void BM_CheckGameOver(BenchState& state) {
+    World world = makeWorld(state.range(), 0);
+    while (state.keepRunning()) {
+        doNotOptimize(checkOutcome(world));
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_CheckGameOver, 100, 1000, 10000, 100000);
+
+// Whole ticks under each tuning, fire held while sweeping side to side;
+// a finished game starts over
+template <typename Config>
+static void runTicks(BenchState& state, TuningId tuning) {
+    World world;
+    setTuning(world, tuning);
+    resetWorld(world);
+    while (state.keepRunning()) {
+        for (long long t = 0; t < state.range(); ++t) {
+            std::uint8_t input = INPUT_FIRE | ((t / 90) % 2 ? INPUT_LEFT : INPUT_RIGHT);
+            stepWorld<Config>(world, input);
+            if (checkOutcome(world) != Outcome::Playing) {
+                resetWorld(world);
+            }
+        }
+    }
+    doNotOptimize(world.score);
+    state.setItemsProcessed(state.range());
+}
+
+static void BM_StepClassic(BenchState& state) {
+    runTicks<ClassicTuning>(state, TuningId::Classic);
+}
+BENCHMARK(BM_StepClassic, 1000);
+
+static void BM_StepDense(BenchState& state) {
+    runTicks<DenseTuning>(state, TuningId::Dense);
+}
+BENCHMARK(BM_StepDense, 1000);
+
+static void BM_StepStress(BenchState& state) {
+    runTicks<StressTuning>(state, TuningId::Stress);
+}
+BENCHMARK(BM_StepStress, 1000);
@@ -0,0 +1,34 @@
+#include "bench.h"
+#include "../rewind.h"
+#include "../world.h"
+
+// What a network rollback costs: restore the world from N ticks back and
+// simulate those N ticks again, pushing each into the history like
+// NetSession does. Two players firing in the dense tuning, with the
+// history kept the way the session keeps it (32 ticks, a keyframe every 4).
+
+static const std::uint8_t BOTH_FIRING = INPUT_FIRE | INPUT_LEFT | (INPUT_FIRE | INPUT_RIGHT) << INPUT_P2_SHIFT;
+
+static void BM_Rollback(BenchState& state) {
+    const std::size_t ticks = (std::size_t)state.range();
+    World world;
+    setTuning(world, TuningId::Dense);
+    world.players = 2;
+    resetWorld(world);
+    RewindBuffer history(32, 4 << 20, 4);
+    history.push(world);
+    for (int t = 0; t < 120; ++t) {
+        stepWorld(world, BOTH_FIRING);
+        history.push(world);
+    }
+    while (state.keepRunning()) {
+        history.rewind(world, ticks);
+        for (std::size_t t = 0; t < ticks; ++t) {
+            stepWorld(world, BOTH_FIRING);
+            history.push(world);
+        }
+    }
+    doNotOptimize(world.score);
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_Rollback, 1, 2, 4, 8);
@@ -0,0 +1,94 @@
+#include <random>
+
+#include "bench.h"
+#include "../formation.h"
+#include "../world.h"
+
+// Enemy shots and debris at bullet-hell density: the integrate step under
+// each kernel, and a whole tick of particle work (integrate both pools and
+// test the shots against the player) with every particle alive.
+
+// Fills the pool with n particles scattered above the player, drifting
+// slowly so none of them leave or touch it while timing
+static void fillPool(ParticlePool& pool, long long n, std::mt19937& rng) {
+    std::uniform_real_distribution<float> xs(0.0f, (float)WINDOW_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, WINDOW_HEIGHT / 2.0f);
+    std::uniform_real_distribution<float> vs(-0.001f, 0.001f);
+    pool.clear();
+    for (long long i = 0; i < n; ++i) {
+        pool.spawn(xs(rng), ys(rng), vs(rng), vs(rng), 65535, (std::uint8_t)(i & 3));
+    }
+}
+
+// Tops the particles' lives back up, untimed, before they could run out
+static void keepAlive(BenchState& state, ParticlePool& pool, long long n, std::mt19937& rng) {
+    if (pool.life[pool.tail()] < 1000) {
+        state.pauseTiming();
+        fillPool(pool, n, rng);
+        state.resumeTiming();
+    }
+}
+
+static void runIntegrate(BenchState& state, FormationKernel kernel) {
+    FormationKernel saved = activeFormationKernel();
+    setFormationKernel(kernel);
+    std::mt19937 rng(5);
+    ParticlePool pool;
+    pool.reserve(state.range(), DEBRIS_SIZE, DEBRIS_SIZE);
+    fillPool(pool, state.range(), rng);
+    while (state.keepRunning()) {
+        integrateParticles(pool);
+        keepAlive(state, pool, state.range(), rng);
+    }
+    doNotOptimize(pool.y[0]);
+    state.setItemsProcessed(state.range());
+    setFormationKernel(saved);
+}
+
+static void BM_IntegrateParticlesScalar(BenchState& state) {
+    runIntegrate(state, FormationKernel::Scalar);
+}
+BENCHMARK(BM_IntegrateParticlesScalar, 1000, 10000, 50000, 100000);
+
+static void BM_IntegrateParticlesSSE(BenchState& state) {
+    runIntegrate(state, FormationKernel::SSE);
+}
+BENCHMARK(BM_IntegrateParticlesSSE, 1000, 10000, 50000, 100000);
+
+static void BM_IntegrateParticlesAVX2(BenchState& state) {
+    runIntegrate(state, FormationKernel::AVX2);
+}
+BENCHMARK(BM_IntegrateParticlesAVX2, 1000, 10000, 50000, 100000);
+
+// Half shots, half debris
+static void BM_ParticleTick(BenchState& state) {
+    std::mt19937 rng(9);
+    World world;
+    world.shotCapacity = state.range() / 2;
+    world.debrisCapacity = state.range() / 2;
+    resetWorld(world);
+    fillPool(world.shots, state.range() / 2, rng);
+    fillPool(world.debris, state.range() / 2, rng);
+    while (state.keepRunning()) {
+        updateParticles<ClassicTuning>(world);
+        keepAlive(state, world.shots, state.range() / 2, rng);
+        keepAlive(state, world.debris, state.range() / 2, rng);
+    }
+    doNotOptimize(world.playerHit);
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_ParticleTick, 1000, 10000, 50000, 100000);
+
+static void BM_SpawnExplosion(BenchState& state) {
+    World world;
+    world.debrisCapacity = 65536;
+    resetWorld(world);
+    while (state.keepRunning()) {
+        for (long long i = 0; i < state.range(); ++i) {
+            spawnExplosion<ClassicTuning>(world, 400.0f, 300.0f);
+        }
+    }
+    doNotOptimize(world.debris.head);
+    state.setItemsProcessed(state.range() * ClassicTuning::DEBRIS_PER_EXPLOSION);
+}
+BENCHMARK(BM_SpawnExplosion, 100);
@@ -0,0 +1,49 @@
+#include "bench.h"
+#include "../profiler.h"
+#include "../world.h"
+
+// Cost of the phase timers inside stepWorld: no profiler attached, one
+// attached but disabled (the default in the game), and one recording.
+// Each iteration plays range() ticks of the default formation with fire held.
+
+static void playTicks(World& world, long long ticks) {
+    for (long long t = 0; t < ticks; ++t) {
+        std::uint8_t input = INPUT_FIRE | ((t / 90) % 2 ? INPUT_LEFT : INPUT_RIGHT);
+        stepWorld(world, input);
+        if (checkOutcome(world) != Outcome::Playing) {
+            resetWorld(world);
+        }
+    }
+}
+
+static void runWithProfiler(BenchState& state, FrameProfiler* profiler) {
+    World world;
+    world.profiler = profiler;
+    resetWorld(world);
+    while (state.keepRunning()) {
+        playTicks(world, state.range());
+        if (profiler != nullptr) {
+            profiler->endFrame();
+        }
+    }
+    doNotOptimize(world.score);
+    state.setItemsProcessed(state.range());
+}
+
+static void BM_StepWorldNoProfiler(BenchState& state) {
+    runWithProfiler(state, nullptr);
+}
+BENCHMARK(BM_StepWorldNoProfiler, 1000);
+
+static void BM_StepWorldProfilerDisabled(BenchState& state) {
+    FrameProfiler profiler;
+    runWithProfiler(state, &profiler);
+}
+BENCHMARK(BM_StepWorldProfilerDisabled, 1000);
+
+static void BM_StepWorldProfilerEnabled(BenchState& state) {
+    FrameProfiler profiler;
+    profiler.enabled = true;
+    runWithProfiler(state, &profiler);
+}
+BENCHMARK(BM_StepWorldProfilerEnabled, 1000);
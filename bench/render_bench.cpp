@@ -0,0 +1,110 @@
+// Needs SFML's graphics module; built only with -DBENCH_SFML
+#ifdef BENCH_SFML
+
+#include <cstdio>
+#include <cstdlib>
+#include <random>
+#include <string>
+
+#include "bench.h"
+#include "../layers.h"
+#include "../renderer.h"
+
+// CPU side of draw submission: rewriting the persistent batch vertex
+// arrays from the world. Submitting them needs a GL context, so it is
+// left to the in-game RenderStats.
+
+static void BM_BuildRenderBatches(BenchState& state) {
+    std::mt19937 rng(7);
+    std::uniform_real_distribution<float> xs(0.0f, (float)WINDOW_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, (float)WINDOW_HEIGHT);
+
+    World world;
+    world.enemies.reserve(state.range());
+    world.bullets.reserve(state.range());
+    for (long long i = 0; i < state.range(); ++i) {
+        world.enemies.add(xs(rng), ys(rng), DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT);
+        world.bullets.add(xs(rng), ys(rng), BULLET_WIDTH, BULLET_HEIGHT);
+    }
+
+    sf::Texture enemyTexture;
+    BatchRenderer renderer(enemyTexture);
+    renderer.build(world); // grow the arrays before timing
+    while (state.keepRunning()) {
+        renderer.build(world);
+    }
+    state.setItemsProcessed(state.range() * 2);
+}
+BENCHMARK(BM_BuildRenderBatches, 100, 1000, 10000, 100000);
+
+// Appending live particles to the bullet batch, every one alive
+static void BM_BuildParticleVertices(BenchState& state) {
+    std::mt19937 rng(3);
+    std::uniform_real_distribution<float> xs(0.0f, (float)WINDOW_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, (float)WINDOW_HEIGHT);
+
+    ParticlePool particles;
+    particles.reserve(state.range(), DEBRIS_SIZE, DEBRIS_SIZE);
+    for (long long i = 0; i < state.range(); ++i) {
+        particles.spawn(xs(rng), ys(rng), 1.0f, 1.0f, 100, (std::uint8_t)(i & 3));
+    }
+
+    World world;
+    sf::Texture enemyTexture;
+    BatchRenderer renderer(enemyTexture);
+    renderer.build(world);
+    renderer.addParticles(particles, 0.5f); // grow the arrays before timing
+    while (state.keepRunning()) {
+        renderer.build(world);
+        doNotOptimize(renderer.addParticles(particles, 0.5f));
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_BuildParticleVertices, 1000, 10000, 50000, 100000);
+
+// Score HUD updates: sf::Text re-laying out "Score: N" from a new string
+// against CounterText rewriting its digit quads. Run from the project
+// directory so alien.ttf is found.
+
+static const sf::Font& benchFont() {
+    static sf::Font font;
+    static bool loaded = false;
+    if (!loaded) {
+        if (!font.loadFromFile("alien.ttf")) {
+            std::fprintf(stderr, "alien.ttf not found\n");
+            std::abort();
+        }
+        loaded = true;
+    }
+    return font;
+}
+
+static void BM_ScoreTextLayout(BenchState& state) {
+    sf::Text text("Score: 0", benchFont(), 20);
+    int score = 0;
+    while (state.keepRunning()) {
+        for (long long i = 0; i < state.range(); ++i) {
+            score += 10;
+            text.setString("Score: " + std::to_string(score));
+            doNotOptimize(text.getLocalBounds()); // forces the layout
+        }
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_ScoreTextLayout, 1000);
+
+static void BM_ScoreCounterLayout(BenchState& state) {
+    CounterText text(benchFont(), 20, "Score: ");
+    int score = 0;
+    while (state.keepRunning()) {
+        for (long long i = 0; i < state.range(); ++i) {
+            score += 10;
+            text.setValue(score);
+        }
+        doNotOptimize(text.area());
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_ScoreCounterLayout, 1000);
+
+#endif
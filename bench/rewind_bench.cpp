@@ -0,0 +1,62 @@
+#include <random>
+
+#include "bench.h"
+#include "../rewind.h"
+#include "../state.h"
+
+// Cost of keeping rewind history: one snapshot per tick, and the worst
+// case restore (a keyframe plus the longest chain of deltas). Enemies
+// march between iterations like in the game, so every x changes.
+
+static World makeWorld(long long enemies) {
+    std::mt19937 rng(99);
+    std::uniform_real_distribution<float> xs(0.0f, WINDOW_WIDTH - DEFAULT_ENEMY_WIDTH);
+    std::uniform_real_distribution<float> ys(0.0f, WINDOW_HEIGHT / 2);
+
+    World world;
+    world.enemies.reserve(enemies);
+    world.bullets.reserve(ClassicTuning::BULLET_CAPACITY);
+    for (long long i = 0; i < enemies; ++i) {
+        world.enemies.add(xs(rng), ys(rng), DEFAULT_ENEMY_WIDTH, DEFAULT_ENEMY_HEIGHT);
+    }
+    for (std::size_t i = 0; i < ClassicTuning::BULLET_CAPACITY / 2; ++i) {
+        world.bullets.add(xs(rng), ys(rng), BULLET_WIDTH, BULLET_HEIGHT);
+    }
+    world.enemyGrid.reset(world.enemies.size());
+    return world;
+}
+
+static std::size_t arenaFor(const World& world, std::size_t snapshots) {
+    return worldStateSize(world) * snapshots / 2 + (1 << 20);
+}
+
+static void BM_PushSnapshot(BenchState& state) {
+    World world = makeWorld(state.range());
+    RewindBuffer buffer(600, arenaFor(world, 600));
+    buffer.push(world);
+    while (state.keepRunning()) {
+        state.pauseTiming();
+        updateEnemies<ClassicTuning>(world, TICK_DT);
+        state.resumeTiming();
+        buffer.push(world);
+    }
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_PushSnapshot, 32, 1000, 10000);
+
+static void BM_RestoreWorstCase(BenchState& state) {
+    const std::size_t keyframeInterval = 60;
+    World world = makeWorld(state.range());
+    RewindBuffer buffer(keyframeInterval, arenaFor(world, keyframeInterval), keyframeInterval);
+    for (std::size_t i = 0; i < keyframeInterval; ++i) {
+        updateEnemies<ClassicTuning>(world, TICK_DT);
+        buffer.push(world);
+    }
+    World restored = world;
+    while (state.keepRunning()) {
+        buffer.rewind(restored, 0);
+    }
+    doNotOptimize(restored.enemies.x[0]);
+    state.setItemsProcessed(state.range());
+}
+BENCHMARK(BM_RestoreWorstCase, 32, 1000, 10000);
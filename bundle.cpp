@@ -0,0 +1,202 @@
+#include "bundle.h"
+
+#include <cstdio>
+#include <cstring>
+
+#ifdef _WIN32
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+const char BUNDLE_MAGIC[4] = { 'S', 'W', 'P', 'K' };
+const std::uint32_t BUNDLE_VERSION = 1;
+const std::uint64_t BUNDLE_ALIGNMENT = 16;
+
+AssetBundle::~AssetBundle() {
+    close();
+}
+
+bool AssetBundle::open(const char* path) {
+    close();
+
+#ifdef _WIN32
+    HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+    if (file == INVALID_HANDLE_VALUE) {
+        return false;
+    }
+    LARGE_INTEGER fileSize;
+    HANDLE mapping = nullptr;
+    if (GetFileSizeEx(file, &fileSize) && fileSize.QuadPart > 0) {
+        mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    }
+    if (mapping == nullptr) {
+        CloseHandle(file);
+        return false;
+    }
+    base = (const unsigned char*)MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    fileHandle = file;
+    mappingHandle = mapping;
+    length = (std::size_t)fileSize.QuadPart;
+#else
+    int fd = ::open(path, O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        ::close(fd);
+        return false;
+    }
+    void* mapped = mmap(nullptr, (std::size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd); // the mapping keeps the file alive
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    base = (const unsigned char*)mapped;
+    length = (std::size_t)info.st_size;
+#endif
+
+    if (base == nullptr || !readIndex()) {
+        close();
+        return false;
+    }
+    return true;
+}
+
+void AssetBundle::close() {
+#ifdef _WIN32
+    if (base != nullptr) {
+        UnmapViewOfFile(base);
+    }
+    if (mappingHandle != nullptr) {
+        CloseHandle((HANDLE)mappingHandle);
+    }
+    if (fileHandle != nullptr) {
+        CloseHandle((HANDLE)fileHandle);
+    }
+    mappingHandle = nullptr;
+    fileHandle = nullptr;
+#else
+    if (base != nullptr) {
+        munmap((void*)base, length);
+    }
+#endif
+    base = nullptr;
+    length = 0;
+    entries.clear();
+}
+
+static std::uint64_t readLittle(const unsigned char* p, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= (std::uint64_t)p[i] << (8 * i);
+    }
+    return value;
+}
+
+bool AssetBundle::readIndex() {
+    if (length < 12 || std::memcmp(base, BUNDLE_MAGIC, 4) != 0 || readLittle(base + 4, 4) != BUNDLE_VERSION) {
+        return false;
+    }
+    std::uint32_t count = (std::uint32_t)readLittle(base + 8, 4);
+
+    std::size_t pos = 12;
+    for (std::uint32_t i = 0; i < count; ++i) {
+        if (pos + 2 > length) {
+            return false;
+        }
+        std::size_t nameLength = (std::size_t)readLittle(base + pos, 2);
+        pos += 2;
+        if (pos + nameLength + 16 > length) {
+            return false;
+        }
+        Entry entry;
+        entry.name.assign((const char*)base + pos, nameLength);
+        pos += nameLength;
+        entry.offset = readLittle(base + pos, 8);
+        entry.size = readLittle(base + pos + 8, 8);
+        pos += 16;
+        if (entry.offset > length || entry.size > length - entry.offset) {
+            return false;
+        }
+        entries.push_back(entry);
+    }
+    return true;
+}
+
+const void* AssetBundle::find(const std::string& name, std::size_t& size) const {
+    for (const Entry& entry : entries) {
+        if (entry.name == name) {
+            size = (std::size_t)entry.size;
+            return base + entry.offset;
+        }
+    }
+    size = 0;
+    return nullptr;
+}
+
+static void putLittle(std::vector<unsigned char>& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back((unsigned char)(value >> (8 * i)));
+    }
+}
+
+static bool readWholeFile(const std::string& path, std::vector<unsigned char>& data) {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    unsigned char buffer[65536];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    bool ok = !std::ferror(file);
+    std::fclose(file);
+    return ok;
+}
+
+bool writeBundle(const char* path, const std::vector<std::string>& files) {
+    std::vector<std::vector<unsigned char>> blobs(files.size());
+    std::vector<std::string> names(files.size());
+    std::size_t indexSize = 12;
+    for (size_t i = 0; i < files.size(); ++i) {
+        if (!readWholeFile(files[i], blobs[i])) {
+            std::fprintf(stderr, "cannot read %s\n", files[i].c_str());
+            return false;
+        }
+        std::size_t slash = files[i].find_last_of("/\\");
+        names[i] = slash == std::string::npos ? files[i] : files[i].substr(slash + 1);
+        indexSize += 2 + names[i].size() + 16;
+    }
+
+    std::vector<unsigned char> out(BUNDLE_MAGIC, BUNDLE_MAGIC + 4);
+    putLittle(out, BUNDLE_VERSION, 4);
+    putLittle(out, files.size(), 4);
+
+    std::uint64_t offset = indexSize;
+    for (size_t i = 0; i < files.size(); ++i) {
+        offset = (offset + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT;
+        putLittle(out, names[i].size(), 2);
+        out.insert(out.end(), names[i].begin(), names[i].end());
+        putLittle(out, offset, 8);
+        putLittle(out, blobs[i].size(), 8);
+        offset += blobs[i].size();
+    }
+    for (size_t i = 0; i < files.size(); ++i) {
+        out.resize((out.size() + BUNDLE_ALIGNMENT - 1) / BUNDLE_ALIGNMENT * BUNDLE_ALIGNMENT, 0);
+        out.insert(out.end(), blobs[i].begin(), blobs[i].end());
+    }
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && written;
+}
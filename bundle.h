@@ -0,0 +1,51 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Packed asset bundle: every asset file concatenated behind an index, read
+// through a read-only memory mapping so assets are decoded straight from
+// the page cache without copies.
+//
+// File layout (little-endian):
+//   "SWPK"  u32 version  u32 entry count
+//   per entry: u16 name length, name bytes, u64 offset, u64 size
+//   asset data, each blob starting on a 16-byte boundary
+
+class AssetBundle {
+public:
+    AssetBundle() = default;
+    ~AssetBundle();
+
+    AssetBundle(const AssetBundle&) = delete;
+    AssetBundle& operator=(const AssetBundle&) = delete;
+
+    bool open(const char* path);
+    void close();
+    bool isOpen() const { return base != nullptr; }
+
+    // Returns the bytes of `name`, or nullptr if the bundle lacks it. The
+    // pointer stays valid until the bundle is closed.
+    const void* find(const std::string& name, std::size_t& size) const;
+
+private:
+    struct Entry {
+        std::string name;
+        std::uint64_t offset, size;
+    };
+
+    bool readIndex();
+
+    const unsigned char* base = nullptr;
+    std::size_t length = 0;
+    std::vector<Entry> entries;
+#ifdef _WIN32
+    void* fileHandle = nullptr;
+    void* mappingHandle = nullptr;
+#endif
+};
+
+// Packs `files` into a bundle at `path`; assets are named by file name
+bool writeBundle(const char* path, const std::vector<std::string>& files);
@@ -5,15 +5,14 @@
 #include <ctime> //DELTA TIME
 #include <string> //TO DISPLAY MSG
 
+#include "tuning.h" // GAME CONFIGURATION, SHARED WITH game.cpp
+
 using namespace std;
 
-// Constants for game configuration : CONSTANTS ARE GOOD FOR READABILITY AND GAME CONFIGURATION
-const int WINDOW_WIDTH = 800;
-const int WINDOW_HEIGHT = 600;
-const float PLAYER_SPEED = 300.0f;
-const float BULLET_SPEED = 500.0f;
-float ENEMY_SPEED = 100.0f;
-const float SHOOT_COOLDOWN = 0.5f; // BULLETS DONT SHOOT CONTINIOUSLY RATHER THERE IS A GAP
+// This prototype plays the classic tuning
+const float PLAYER_SPEED = ClassicTuning::PLAYER_SPEED;
+const float BULLET_SPEED = ClassicTuning::BULLET_SPEED;
+const float SHOOT_COOLDOWN = ClassicTuning::SHOOT_COOLDOWN; // BULLETS DONT SHOOT CONTINIOUSLY RATHER THERE IS A GAP
  
 
 // Bullet structure to represent player bullets
@@ -74,8 +73,8 @@ void updateBullets(std::vector<Bullet>& bullets, float dt) { //bullets are store
 }
 
 // Function to update enemies and handle direction changes
-void updateEnemies(std::vector<Enemy>& enemies, float dt, float& direction) {
-    float moveDistance = ENEMY_SPEED * dt * direction; // MULTIPLY BY dt to make the function frame rate independent
+void updateEnemies(std::vector<Enemy>& enemies, float dt, float speed, float& direction) {
+    float moveDistance = speed * dt * direction; // MULTIPLY BY dt to make the function frame rate independent
      //ENEMIES ARE STORED IN VECTOR
 
     for (size_t i = 0; i < enemies.size(); ++i) {
@@ -227,6 +226,7 @@ int main() {
     sf::Clock clock;
     float shootTimer = 0.0f;
     float enemyDirection = 1.0f;
+    float enemySpeed = 100.0f; // rises with the score
 
     // Main game loop
     while (window.isOpen()) {
@@ -262,14 +262,14 @@ int main() {
 
         // Update bullets and enemies
         updateBullets(bullets, dt);
-        updateEnemies(enemies, dt, enemyDirection);
+        updateEnemies(enemies, dt, enemySpeed, enemyDirection);
 
         // Check for bullet-enemy collisions
         checkBulletEnemyCollisions(bullets, enemies, score, hitSound, scoreText);
 
         // Increase difficulty as score increases
         if (score % 50 == 0 && score > 0) {
-            ENEMY_SPEED += 0.60f;
+            enemySpeed += 0.60f;
         }
 
         // Check win condition
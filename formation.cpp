@@ -0,0 +1,212 @@
+#include "formation.h"
+
+#include <algorithm>
+#include <cfloat>
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define FORMATION_X86 1
+#include <immintrin.h>
+#endif
+
+typedef void (*TranslateFunction)(float*, const float*, std::size_t, float, float&, float&);
+typedef void (*ShiftFunction)(float*, std::size_t, float);
+
+static inline void accumulate(float px, float pw, float& lo, float& hi) {
+    lo = px < lo ? px : lo;
+    hi = px + pw > hi ? px + pw : hi;
+}
+
+static void translateScalar(float* x, const float* w, std::size_t n, float dx, float& left, float& right) {
+    // Two independent min/max chains so the loop isn't latency bound
+    float lo0 = FLT_MAX, lo1 = FLT_MAX;
+    float hi0 = -FLT_MAX, hi1 = -FLT_MAX;
+    std::size_t i = 0;
+    for (; i + 2 <= n; i += 2) {
+        float p0 = x[i] + dx, p1 = x[i + 1] + dx;
+        x[i] = p0;
+        x[i + 1] = p1;
+        accumulate(p0, w[i], lo0, hi0);
+        accumulate(p1, w[i + 1], lo1, hi1);
+    }
+    if (i < n) {
+        float p0 = x[i] + dx;
+        x[i] = p0;
+        accumulate(p0, w[i], lo0, hi0);
+    }
+    left = std::min(lo0, lo1);
+    right = std::max(hi0, hi1);
+}
+
+static void shiftScalar(float* y, std::size_t n, float dy) {
+    for (std::size_t i = 0; i < n; ++i) {
+        y[i] += dy;
+    }
+}
+
+#ifdef FORMATION_X86
+
+__attribute__((target("sse2")))
+static void translateSSE(float* x, const float* w, std::size_t n, float dx, float& left, float& right) {
+    __m128 delta = _mm_set1_ps(dx);
+    __m128 lo = _mm_set1_ps(FLT_MAX), hi = _mm_set1_ps(-FLT_MAX);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 px = _mm_add_ps(_mm_loadu_ps(x + i), delta);
+        _mm_storeu_ps(x + i, px);
+        lo = _mm_min_ps(lo, px);
+        hi = _mm_max_ps(hi, _mm_add_ps(px, _mm_loadu_ps(w + i)));
+    }
+
+    float lanes[4];
+    _mm_storeu_ps(lanes, lo);
+    float l = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, hi);
+    float r = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    for (; i < n; ++i) {
+        x[i] += dx;
+        l = std::min(l, x[i]);
+        r = std::max(r, x[i] + w[i]);
+    }
+    left = l;
+    right = r;
+}
+
+__attribute__((target("sse2")))
+static void shiftSSE(float* y, std::size_t n, float dy) {
+    __m128 delta = _mm_set1_ps(dy);
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), delta));
+    }
+    for (; i < n; ++i) {
+        y[i] += dy;
+    }
+}
+
+__attribute__((target("avx2")))
+static void translateAVX2(float* x, const float* w, std::size_t n, float dx, float& left, float& right) {
+    __m256 delta = _mm256_set1_ps(dx);
+    __m256 lo = _mm256_set1_ps(FLT_MAX), hi = _mm256_set1_ps(-FLT_MAX);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        __m256 px = _mm256_add_ps(_mm256_loadu_ps(x + i), delta);
+        _mm256_storeu_ps(x + i, px);
+        lo = _mm256_min_ps(lo, px);
+        hi = _mm256_max_ps(hi, _mm256_add_ps(px, _mm256_loadu_ps(w + i)));
+    }
+
+    // Fold the two halves, then finish the last four lanes
+    __m128 lo4 = _mm_min_ps(_mm256_castps256_ps128(lo), _mm256_extractf128_ps(lo, 1));
+    __m128 hi4 = _mm_max_ps(_mm256_castps256_ps128(hi), _mm256_extractf128_ps(hi, 1));
+    float lanes[4];
+    _mm_storeu_ps(lanes, lo4);
+    float l = std::min(std::min(lanes[0], lanes[1]), std::min(lanes[2], lanes[3]));
+    _mm_storeu_ps(lanes, hi4);
+    float r = std::max(std::max(lanes[0], lanes[1]), std::max(lanes[2], lanes[3]));
+
+    for (; i < n; ++i) {
+        x[i] += dx;
+        l = std::min(l, x[i]);
+        r = std::max(r, x[i] + w[i]);
+    }
+    left = l;
+    right = r;
+}
+
+__attribute__((target("avx2")))
+static void shiftAVX2(float* y, std::size_t n, float dy) {
+    __m256 delta = _mm256_set1_ps(dy);
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), delta));
+    }
+    for (; i < n; ++i) {
+        y[i] += dy;
+    }
+}
+
+#endif
+
+bool formationKernelSupported(FormationKernel kernel) {
+#ifdef FORMATION_X86
+    // May run from a static initializer, before the CPU model is filled in
+    __builtin_cpu_init();
+#endif
+    switch (kernel) {
+    case FormationKernel::Scalar:
+        return true;
+#ifdef FORMATION_X86
+    case FormationKernel::SSE:
+        return __builtin_cpu_supports("sse2");
+    case FormationKernel::AVX2:
+        return __builtin_cpu_supports("avx2");
+#endif
+    default:
+        return false;
+    }
+}
+
+static FormationKernel detectKernel() {
+    if (formationKernelSupported(FormationKernel::AVX2)) {
+        return FormationKernel::AVX2;
+    }
+    if (formationKernelSupported(FormationKernel::SSE)) {
+        return FormationKernel::SSE;
+    }
+    return FormationKernel::Scalar;
+}
+
+static FormationKernel currentKernel = detectKernel();
+static TranslateFunction translateImpl = translateScalar;
+static ShiftFunction shiftImpl = shiftScalar;
+static bool kernelBound = false;
+
+void setFormationKernel(FormationKernel kernel) {
+    if (!formationKernelSupported(kernel)) {
+        kernel = FormationKernel::Scalar;
+    }
+    currentKernel = kernel;
+    translateImpl = translateScalar;
+    shiftImpl = shiftScalar;
+#ifdef FORMATION_X86
+    if (kernel == FormationKernel::SSE) {
+        translateImpl = translateSSE;
+        shiftImpl = shiftSSE;
+    }
+    else if (kernel == FormationKernel::AVX2) {
+        translateImpl = translateAVX2;
+        shiftImpl = shiftAVX2;
+    }
+#endif
+    kernelBound = true;
+}
+
+FormationKernel activeFormationKernel() {
+    return currentKernel;
+}
+
+const char* formationKernelName(FormationKernel kernel) {
+    switch (kernel) {
+    case FormationKernel::SSE:
+        return "sse";
+    case FormationKernel::AVX2:
+        return "avx2";
+    default:
+        return "scalar";
+    }
+}
+
+void translateFormation(float* x, const float* w, std::size_t n, float dx, float& left, float& right) {
+    if (!kernelBound) {
+        setFormationKernel(currentKernel);
+    }
+    translateImpl(x, w, n, dx, left, right);
+}
+
+void shiftFormation(float* y, std::size_t n, float dy) {
+    if (!kernelBound) {
+        setFormationKernel(currentKernel);
+    }
+    shiftImpl(y, n, dy);
+}
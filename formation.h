@@ -0,0 +1,26 @@
+#pragma once
+
+#include <cstddef>
+
+// Vectorized kernels for moving the enemy formation. The best kernel for
+// the running CPU is picked once at startup: AVX2 or SSE on x86, plain
+// scalar code everywhere else.
+
+enum class FormationKernel {
+    Scalar,
+    SSE,
+    AVX2
+};
+
+// Adds dx to every x and returns the formation's left edge (min x) and
+// right edge (max x + w) in one pass
+void translateFormation(float* x, const float* w, std::size_t n, float dx, float& left, float& right);
+
+// Adds dy to every y
+void shiftFormation(float* y, std::size_t n, float dy);
+
+FormationKernel activeFormationKernel();
+const char* formationKernelName(FormationKernel kernel);
+bool formationKernelSupported(FormationKernel kernel);
+// Overrides the detected kernel; used by the benchmarks
+void setFormationKernel(FormationKernel kernel);
@@ -0,0 +1,19 @@
+#include "frame.h"
+
+void captureWorld(const World& world, FrameSnapshot& frame) {
+    frame.score = world.score;
+    frame.playerX = world.playerX;
+    frame.playerY = world.playerY;
+    frame.playerStepX = world.playerStepX;
+    frame.players = world.players;
+    frame.player2X = world.player2X;
+    frame.player2StepX = world.player2StepX;
+    frame.enemyStepX = world.enemyStepX;
+    frame.enemyStepY = world.enemyStepY;
+    frame.bulletStepY = withTuning(world.tuning, [](auto config) { return -decltype(config)::BULLET_SPEED * TICK_DT; });
+    frame.bullets = world.bullets;
+    frame.enemies = world.enemies;
+    frame.shots = world.shots;
+    frame.debris = world.debris;
+    frame.tick = world.tick;
+}
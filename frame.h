@@ -0,0 +1,80 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <string>
+
+#include "world.h"
+
+// Everything the renderer needs to draw one frame, copied out of the game
+// so drawing never reads state the simulation is changing. Kept free of
+// SFML like the simulation core.
+
+enum class GameState {
+    Menu,
+    Playing,
+    Won,
+    Lost,
+    Restarting
+};
+
+struct FrameSnapshot {
+    GameState state = GameState::Menu;
+    float stateTime = 0.0f; // seconds spent in `state`
+    bool assetsReady = false;
+    int score = 0;
+
+    // Positions after the newest tick, plus how far things moved during it
+    float playerX = 0, playerY = 0, playerStepX = 0;
+    int players = 1;
+    float player2X = 0, player2StepX = 0;
+    float enemyStepX = 0, enemyStepY = 0;
+    float bulletStepY = 0; // bullets always move the same distance
+    EntityArrays bullets, enemies;
+    ParticlePool shots, debris;
+    std::uint32_t tick = 0;
+
+    // Clock readings (microseconds) for interpolation and latency stats:
+    // when the newest tick ran and when the input it used was read
+    std::int64_t tickMicros = 0;
+    std::int64_t inputMicros = 0;
+
+    bool showProfile = false;
+    int profileVersion = 0; // bumped whenever profileText changes
+    std::string profileText;
+};
+
+// Copies the world's drawable state; reuses the snapshot's storage, so
+// this doesn't allocate once the snapshot has seen the largest world
+void captureWorld(const World& world, FrameSnapshot& frame);
+
+// Single-producer, single-consumer triple buffer. The writer fills back()
+// and publish() swaps it with the shared middle slot; the reader's
+// acquire() swaps the middle slot into front() if anything new was
+// published. Neither side ever waits for the other: the writer can
+// publish at its own rate and the reader always has a complete frame.
+template <typename T>
+class TripleBuffer {
+public:
+    T& back() { return slots[backIndex]; }
+    void publish() { backIndex = middle.exchange(backIndex | FRESH, std::memory_order_acq_rel) & INDEX_MASK; }
+
+    // Returns false (keeping the old front) if nothing new was published
+    bool acquire() {
+        if ((middle.load(std::memory_order_relaxed) & FRESH) == 0) {
+            return false;
+        }
+        frontIndex = middle.exchange(frontIndex, std::memory_order_acq_rel) & INDEX_MASK;
+        return true;
+    }
+    const T& front() const { return slots[frontIndex]; }
+
+private:
+    static const unsigned INDEX_MASK = 3;
+    static const unsigned FRESH = 4;
+
+    T slots[3];
+    unsigned backIndex = 0;
+    unsigned frontIndex = 1;
+    std::atomic<unsigned> middle{ 2 };
+};
@@ -4,268 +4,563 @@
 #include <cstdlib>
 #include <ctime>
 #include <string>
+#include <cstdio>
+#include <algorithm>
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <thread>
+
+#include "assets.h"
+#include "audio.h"
+#include "frame.h"
+#include "netplay.h"
+#include "pacer.h"
+#include "profiler.h"
+#include "renderer.h"
+#include "replay.h"
+#include "rewind.h"
+#include "scene.h"
+#include "state.h"
+#include "waves.h"
+#include "world.h"
 
 using namespace std;
 
-const int WINDOW_WIDTH = 800;
-const int WINDOW_HEIGHT = 600;
-const float PLAYER_SPEED = 300.0f;
-const float BULLET_SPEED = 500.0f;
-float ENEMY_SPEED = 100.0f;
-const float SHOOT_COOLDOWN = 0.5f;
+// F5 saves the game in progress here and F9 loads it back
+const char* QUICKSAVE_PATH = "quicksave.sws";
+// Enemy waves; edits are picked up while the game runs
+const char* WAVES_PATH = "waves.txt";
 
-struct Bullet {
-    sf::RectangleShape shape;
-};
+std::uint8_t readInput() {
+    std::uint8_t input = 0;
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left)) {
+        input |= INPUT_LEFT;
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right)) {
+        input |= INPUT_RIGHT;
+    }
+    if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space)) {
+        input |= INPUT_FIRE;
+    }
+    return input;
+}
 
-struct Enemy {
-    sf::Sprite sprite;
+// Written by whichever thread presents frames
+struct DisplayStats {
+    std::atomic<std::int64_t> firstFrameMicros{ -1 };
+    FramePacer pacer; // paces presentation and times every presented frame
+    std::uint32_t shownTick = 0;
+    RenderStats render;
 };
 
-void showStartMenu(sf::RenderWindow& window, sf::Font& font) {
-    sf::Text titleText("Space Invaders", font, 50);
-    titleText.setFillColor(sf::Color::Red);
-    titleText.setPosition(WINDOW_WIDTH / 2 - titleText.getGlobalBounds().width / 2, WINDOW_HEIGHT / 3);
-
-    sf::Text instructionText("Press Enter to Start", font, 30);
-    instructionText.setFillColor(sf::Color::White);
-    instructionText.setPosition(WINDOW_WIDTH / 2 - instructionText.getGlobalBounds().width / 2, WINDOW_HEIGHT / 2);
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
-            }
-        }
-
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Enter)) {
-            break;
-        }
-
-        window.clear();
-        window.draw(titleText);
-        window.draw(instructionText);
-        window.display();
+// Call right after display()
+void recordDisplay(DisplayStats& stats, const FrameSnapshot& frame, std::int64_t now) {
+    if (stats.firstFrameMicros.load(std::memory_order_relaxed) < 0) {
+        stats.firstFrameMicros.store(now, std::memory_order_relaxed);
     }
+    bool newTick = frame.state == GameState::Playing && frame.tick != stats.shownTick;
+    stats.pacer.presented(now, newTick ? frame.inputMicros : -1);
+    stats.shownTick = frame.tick;
 }
 
-void updateBullets(std::vector<Bullet>& bullets, float dt) {
-    for (size_t i = 0; i < bullets.size(); ++i) {
-        bullets[i].shape.move(0, -BULLET_SPEED * dt);
-
-        if (bullets[i].shape.getPosition().y < 0) {
-            bullets.erase(bullets.begin() + i);
-            --i;
-        }
+// Render thread: owns the window's GL context and draws the newest
+// snapshot every frame, paced by stats.pacer. Events are still polled on
+// the main thread, which SFML requires on some platforms.
+void renderLoop(sf::RenderWindow& window, Scene& scene, TripleBuffer<FrameSnapshot>& frames, const sf::Clock& appClock,
+                const std::atomic<bool>& running, DisplayStats& stats) {
+    window.setActive(true);
+    sf::Clock renderClock;
+    while (running.load(std::memory_order_relaxed)) {
+        // Wait first, so the frame drawn is the newest one when it's due
+        stats.pacer.wait();
+        frames.acquire();
+        const FrameSnapshot& frame = frames.front();
+
+        // Interpolate by how far the clock has moved past the newest tick
+        std::int64_t sinceTick = appClock.getElapsedTime().asMicroseconds() - frame.tickMicros;
+        float alpha = std::min(1.0f, std::max(0.0f, sinceTick / (TICK_DT * 1e6f)));
+
+        renderClock.restart();
+        int drawCalls = scene.draw(window, frame, alpha);
+        recordRenderFrame(stats.render, drawCalls, scene.pixelsFilled(), renderClock.getElapsedTime());
+        window.display();
+        recordDisplay(stats, frame, appClock.getElapsedTime().asMicroseconds());
     }
+    window.setActive(false);
 }
 
-void updateEnemies(std::vector<Enemy>& enemies, float dt, float& direction) {
-    float moveDistance = ENEMY_SPEED * dt * direction;
-
-    for (size_t i = 0; i < enemies.size(); ++i) {
-        enemies[i].sprite.move(moveDistance, 0);
-
-        if (enemies[i].sprite.getPosition().x <= 0 ||
-            enemies[i].sprite.getPosition().x >= WINDOW_WIDTH - enemies[i].sprite.getGlobalBounds().width) {
-            direction *= -1;
-            for (size_t j = 0; j < enemies.size(); ++j) {
-                enemies[j].sprite.move(0, 10); // Move down when direction changes
-            }
-            break;
-        }
+void printFrameTiming(bool renderThread, const RunningStats& tickIntervals, const FramePacer& pacer) {
+    if (tickIntervals.count == 0) {
+        return;
+    }
+    const RunningStats& frames = pacer.frameTimes();
+    const RunningStats& latency = pacer.latency();
+    printf("timing (%s): tick interval %.2f ms mean, %.2f ms jitter (stddev), %.2f ms max; "
+           "input to display %.2f ms mean, %.2f ms max\n",
+           renderThread ? "render thread" : "single thread", tickIntervals.mean(), tickIntervals.stddev(),
+           tickIntervals.max, latency.mean(), latency.max);
+    if (pacer.rate() > 0) {
+        printf("pacing (%.0f Hz): ", pacer.rate());
+    }
+    else {
+        printf("pacing (uncapped): ");
     }
+    printf("frame time %.2f ms mean, %.3f ms jitter (stddev), %.2f ms max, %lld frames missed\n", frames.mean(),
+           frames.stddev(), frames.max, pacer.missedFrames());
 }
 
-void checkBulletEnemyCollisions(std::vector<Bullet>& bullets, std::vector<Enemy>& enemies, int& score, sf::Sound& hitSound, sf::Text& scoreText) {
-    for (size_t i = 0; i < bullets.size();) {
-        bool hit = false;
-        for (size_t j = 0; j < enemies.size();) {
-            if (bullets[i].shape.getGlobalBounds().intersects(enemies[j].sprite.getGlobalBounds())) {
-                bullets.erase(bullets.begin() + i);
-                enemies.erase(enemies.begin() + j);
-                hitSound.play();
-                score += 10;
-                scoreText.setString("Score: " + to_string(score));
-                hit = true;
-                break;
-            }
-            else {
-                ++j;
+int main(int argc, char** argv) {
+    // --record FILE saves this session's inputs for replay by the headless driver
+    // --profile shows the frame profiler overlay (toggle with F3)
+    // --profile-csv FILE writes per-phase timings for every frame
+    // --bundle FILE loads assets from a packed bundle (default assets.pak)
+    // --loose-assets ignores the bundle and loads the individual files
+    // --render-thread draws and presents on a separate thread
+    // --no-layer-cache redraws the static backdrop every frame instead of caching it
+    // --tuning NAME plays the classic, dense or stress tuning (see tuning.h)
+    // --fps N presents N frames a second (default 60); 0 runs uncapped
+    // --pacing-csv FILE writes frame time, wait and input latency for every frame
+    // --player 0|1 --port N --peer HOST:PORT plays a two-player game over UDP
+    //   against another copy started with the other player number; both need
+    //   the same --tuning, waves and --input-delay N (default 2). --rtt MS,
+    //   --jitter MS and --loss PERCENT put a simulated network on this side's
+    //   sends. Rewind, quicksave and recording are off in a network game.
+    sf::Clock appClock; // shared by both threads for timestamps
+    const char* recordPath = nullptr;
+    const char* profileCsvPath = nullptr;
+    const char* pacingCsvPath = nullptr;
+    double fps = 60.0;
+    const char* bundlePath = "assets.pak";
+    bool showProfile = false;
+    bool useRenderThread = false;
+    bool cacheLayers = true;
+    TuningId tuning = TuningId::Classic;
+    int netPlayer = -1;
+    int netPort = 0;
+    const char* netPeer = nullptr;
+    std::uint32_t inputDelay = 2;
+    LinkShim shim;
+    for (int i = 1; i < argc; ++i) {
+        if (string(argv[i]) == "--bundle" && i + 1 < argc) {
+            bundlePath = argv[++i];
+        }
+        else if (string(argv[i]) == "--loose-assets") {
+            bundlePath = nullptr;
+        }
+        else if (string(argv[i]) == "--record" && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (string(argv[i]) == "--profile") {
+            showProfile = true;
+        }
+        else if (string(argv[i]) == "--profile-csv" && i + 1 < argc) {
+            profileCsvPath = argv[++i];
+        }
+        else if (string(argv[i]) == "--fps" && i + 1 < argc) {
+            fps = atof(argv[++i]);
+        }
+        else if (string(argv[i]) == "--pacing-csv" && i + 1 < argc) {
+            pacingCsvPath = argv[++i];
+        }
+        else if (string(argv[i]) == "--render-thread") {
+            useRenderThread = true;
+        }
+        else if (string(argv[i]) == "--no-layer-cache") {
+            cacheLayers = false;
+        }
+        else if (string(argv[i]) == "--tuning" && i + 1 < argc) {
+            if (!findTuning(argv[++i], tuning)) {
+                fprintf(stderr, "unknown tuning: %s\n", argv[i]);
+                return 2;
             }
         }
-        if (!hit) {
-            ++i;
+        else if (string(argv[i]) == "--player" && i + 1 < argc) {
+            netPlayer = atoi(argv[++i]) != 0 ? 1 : 0;
+        }
+        else if (string(argv[i]) == "--port" && i + 1 < argc) {
+            netPort = atoi(argv[++i]);
+        }
+        else if (string(argv[i]) == "--peer" && i + 1 < argc) {
+            netPeer = argv[++i];
+        }
+        else if (string(argv[i]) == "--input-delay" && i + 1 < argc) {
+            inputDelay = (std::uint32_t)strtoul(argv[++i], nullptr, 10);
+        }
+        else if (string(argv[i]) == "--rtt" && i + 1 < argc) {
+            shim.delayMs = (float)atof(argv[++i]) * 0.5f;
+        }
+        else if (string(argv[i]) == "--jitter" && i + 1 < argc) {
+            shim.jitterMs = (float)atof(argv[++i]);
+        }
+        else if (string(argv[i]) == "--loss" && i + 1 < argc) {
+            shim.loss = (float)atof(argv[++i]) / 100.0f;
         }
     }
-}
-
-void checkWinCondition(const std::vector<Enemy>& enemies, int score, sf::RenderWindow& window, sf::Text& scoreText) {
-    if (enemies.empty()) {
-        scoreText.setString("    You Win!\nFinal Score: " + to_string(score));
-        scoreText.setFillColor(sf::Color::Green);
-        sf::FloatRect textBounds = scoreText.getGlobalBounds();
-        scoreText.setPosition(WINDOW_WIDTH / 2 - textBounds.width / 2, WINDOW_HEIGHT / 2 - textBounds.height / 2);
-
-        window.clear();
-        window.draw(scoreText);
-        window.display();
-        sf::sleep(sf::seconds(3));
-        window.close();
-    }
-}
 
-void checkGameOver(const std::vector<Enemy>& enemies, const sf::Sprite& player, int score, sf::RenderWindow& window, sf::Text& scoreText) {
-    for (size_t i = 0; i < enemies.size(); ++i) {
-        if (enemies[i].sprite.getPosition().y > WINDOW_HEIGHT - player.getGlobalBounds().height) {
-            scoreText.setFillColor(sf::Color::Red);
-            scoreText.setString("   Game Over!\nFinal Score: " + to_string(score));
-            sf::FloatRect textBounds = scoreText.getGlobalBounds();
-            scoreText.setPosition(WINDOW_WIDTH / 2 - textBounds.width / 2, WINDOW_HEIGHT / 2 - textBounds.height / 2);
-
-            window.clear();
-            window.draw(scoreText);
-            window.display();
-            sf::sleep(sf::seconds(3));
-            window.close();
-            break;
+    // Network game: the session owns the second player and the timeline
+    unique_ptr<NetSession> session;
+    if (netPlayer >= 0) {
+        if (netPeer == nullptr || netPort <= 0) {
+            fprintf(stderr, "--player needs --port and --peer\n");
+            return 2;
         }
+        session.reset(new NetSession(netPlayer, inputDelay));
+        string netError;
+        if (!session->open(netPort, netPeer, shim, netError)) {
+            fprintf(stderr, "%s\n", netError.c_str());
+            return 2;
+        }
+        recordPath = nullptr;
     }
-}
 
-int main() {
     sf::RenderWindow window(sf::VideoMode(WINDOW_WIDTH, WINDOW_HEIGHT), "Space Invaders");
-    window.setFramerateLimit(60);
 
-    // Load textures
-    sf::Texture playerTexture, enemyTexture, backgroundTexture;
-    if (!playerTexture.loadFromFile("player.png") ||
-        !enemyTexture.loadFromFile("enemy.png") ||
-        !backgroundTexture.loadFromFile("background.png")) {
+    // Start loading; only the font is ready before the first frame. The
+    // loader is declared first so it outlives the assets: the font and the
+    // music read from its mapped bundle until they are destroyed.
+    AssetLoader loader;
+    GameAssets assets;
+    if (!loader.start(bundlePath, assets)) {
         return -1;
     }
+    bool assetsReady = false, loadReported = false;
 
-    // Background setup
-    sf::Sprite background;
-    background.setTexture(backgroundTexture);
-
-    // Player setup
-    sf::Sprite player(playerTexture);
-    player.setPosition(WINDOW_WIDTH / 2 - player.getGlobalBounds().width / 2, WINDOW_HEIGHT - player.getGlobalBounds().height - 10);
+    // Sprites and text all live in the scene, which draws from snapshots
+    Scene scene(assets, cacheLayers);
+    sf::Clock renderClock;
 
-    // Font and score setup
-    sf::Font font;
-    if (!font.loadFromFile("alien.ttf")) {
+    // Profiler setup
+    FrameProfiler profiler;
+    if (profileCsvPath != nullptr && !profiler.openCsv(profileCsvPath)) {
         return -1;
     }
-    sf::Text scoreText("Score: 0", font, 20);
-    scoreText.setPosition(10, 10);
-    int score = 0;
-
-    // Sound setup
-    sf::SoundBuffer shootBuffer, hitBuffer;
-    if (!shootBuffer.loadFromFile("shoot.mp3") || !hitBuffer.loadFromFile("hit.mp3")) {
-        return -1;
+    profiler.enabled = profiler.enabled || showProfile;
+    string profileSummary;
+    int profileVersion = 0;
+    int profileRefresh = 0;
+
+    // Sound setup; the buffers are filled in by the loader
+    VoicePool sounds(12);
+    int shootEffect = sounds.addEffect(assets.shootBuffer, 3, 1);
+    int hitEffect = sounds.addEffect(assets.hitBuffer, 6, 2);
+
+    // Wave setup; without a wave file the tuning's built-in waves are played
+    WaveSet waves = defaultWaves(tuning);
+    string wavesError;
+    if (!loadWaves(WAVES_PATH, waves, wavesError)) {
+        fprintf(stderr, "%s; using the built-in wave\n", wavesError.c_str());
     }
-    sf::Sound shootSound(shootBuffer);
-    sf::Sound hitSound(hitBuffer);
-
-    // Music setup
-    sf::Music music;
-    if (!music.openFromFile("music.mp3")) {
+    FileWatch wavesWatch(WAVES_PATH);
+    sf::Clock wavesCheckClock;
+
+    // World setup; entity sizes come from the textures once loaded
+    World world;
+    setTuning(world, tuning);
+    world.waves = &waves;
+    world.profiler = &profiler;
+    resetWorld(world);
+
+    // The recording holds the most recent game
+    InputLog inputLog;
+
+    // The last ten seconds of play, for rewinding with Backspace
+    RewindBuffer rewind(10 * 60, 1 << 20);
+
+    // Timing: when the newest tick ran and when its input was read. The
+    // display pacer sets the frame rate; with the render thread presenting,
+    // this loop only has to keep up with the ticks.
+    DisplayStats display;
+    display.pacer.setRate(fps);
+    if (pacingCsvPath != nullptr && !display.pacer.openCsv(pacingCsvPath)) {
         return -1;
     }
-    music.setLoop(true);
-    music.play();
-
-    std::vector<Bullet> bullets;
-    std::vector<Enemy> enemies;
-
-    // Enemy setup
-    int rows = 4, cols = 8;
-    float enemyStartX = 100, enemyStartY = 50, enemySpacing = 60;
-    for (int row = 0; row < rows; ++row) {
-        for (int col = 0; col < cols; ++col) {
-            Enemy enemy;
-            enemy.sprite.setTexture(enemyTexture);
-            enemy.sprite.setPosition(enemyStartX + col * enemySpacing, enemyStartY + row * 40);
-            enemies.push_back(enemy);
-        }
+    FramePacer tickPacer(1.0 / TICK_DT);
+    RunningStats tickIntervals;
+    std::int64_t tickMicros = -1, tickInputMicros = 0, inputMicros = 0;
+
+    // With --render-thread the frame goes through a triple buffer to the
+    // render thread; otherwise it is drawn inline from a single snapshot
+    TripleBuffer<FrameSnapshot> frames;
+    FrameSnapshot inlineFrame;
+    std::atomic<bool> rendering{ true };
+    std::thread renderThread;
+    if (useRenderThread) {
+        window.setActive(false);
+        renderThread = std::thread(renderLoop, std::ref(window), std::ref(scene), std::ref(frames), std::cref(appClock),
+                                   std::cref(rendering), std::ref(display));
     }
 
-    // Show start menu
-    showStartMenu(window, font);
-
     sf::Clock clock;
-    float shootTimer = 0.0f;
-    float enemyDirection = 1.0f;
-
-    while (window.isOpen()) {
-        sf::Event event;
-        while (window.pollEvent(event)) {
-            if (event.type == sf::Event::Closed) {
-                window.close();
+    FixedTimestep timestep;
+    GameState state = GameState::Menu;
+    float stateTime = 0.0f;
+    bool quit = false;
+    int exitCode = 0;
+
+    while (!quit) {
+        std::uint8_t input = 0;
+        bool enterPressed = false, escapePressed = false;
+        bool savePressed = false, loadPressed = false, rewindHeld = false;
+        {
+            ScopedTimer timer(&profiler, PHASE_INPUT);
+            sf::Event event;
+            while (window.pollEvent(event)) {
+                if (event.type == sf::Event::Closed) {
+                    quit = true;
+                }
+                if (event.type == sf::Event::KeyPressed) {
+                    if (event.key.code == sf::Keyboard::F3) {
+                        showProfile = !showProfile;
+                        profiler.enabled = showProfile || profileCsvPath != nullptr;
+                    }
+                    enterPressed = enterPressed || event.key.code == sf::Keyboard::Enter;
+                    escapePressed = escapePressed || event.key.code == sf::Keyboard::Escape;
+                    savePressed = savePressed || event.key.code == sf::Keyboard::F5;
+                    loadPressed = loadPressed || event.key.code == sf::Keyboard::F9;
+                }
             }
         }
 
-        float dt = clock.restart().asSeconds();
-        shootTimer -= dt;
-
-        // Player movement
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Left) && player.getPosition().x > 0) {
-            player.move(-PLAYER_SPEED * dt, 0);
+        float frameDt = clock.restart().asSeconds();
+        stateTime += frameDt;
+
+        // Finish loading: size the world from the textures and collide
+        // against the enemy's solid pixels
+        if (!assetsReady && loader.poll(assets)) {
+            assetsReady = true;
+            world.enemyMask = &assets.enemyMask;
+            world.playerWidth = (float)assets.playerTexture.getSize().x;
+            world.playerHeight = (float)assets.playerTexture.getSize().y;
+            world.enemyWidth = (float)assets.enemyTexture.getSize().x;
+            world.enemyHeight = (float)assets.enemyTexture.getSize().y;
+
+            if (assets.hasMusic) {
+                assets.music.setLoop(true);
+                assets.music.play();
+            }
         }
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Right) &&
-            player.getPosition().x < WINDOW_WIDTH - player.getGlobalBounds().width) {
-            player.move(PLAYER_SPEED * dt, 0);
+        if (loader.failed()) {
+            exitCode = -1;
+            break;
         }
-
-        // Shooting bullets
-        if (sf::Keyboard::isKeyPressed(sf::Keyboard::Space) && shootTimer <= 0) {
-            Bullet bullet;
-            bullet.shape.setSize({ 5, 20 });
-            bullet.shape.setFillColor(sf::Color::Red);
-            bullet.shape.setPosition(player.getPosition().x + player.getGlobalBounds().width / 2 - 2.5f, player.getPosition().y);
-            bullets.push_back(bullet);
-            shootSound.play();
-            shootTimer = SHOOT_COOLDOWN;
+        std::int64_t firstFrameMicros = display.firstFrameMicros.load(std::memory_order_relaxed);
+        if (assetsReady && !loadReported && firstFrameMicros >= 0) {
+            printf("assets (%s): first frame after %.1f ms, all loaded after %.1f ms\n",
+                   loader.usingBundle() ? "bundle" : "loose files", firstFrameMicros / 1000.0,
+                   loader.loadSeconds() * 1000.0f);
+            loadReported = true;
         }
 
-        // Update bullets and enemies
-        updateBullets(bullets, dt);
-        updateEnemies(enemies, dt, enemyDirection);
-
-        // Check for bullet-enemy collisions
-        checkBulletEnemyCollisions(bullets, enemies, score, hitSound, scoreText);
+        // Pick up wave file edits once a second; a bad edit keeps the old
+        // waves. The current wave restarts with the new layout, or the
+        // whole game when recording so the log matches its waves.
+        // A network game keeps the waves it started with, the same as the peer's
+        if (!session && wavesCheckClock.getElapsedTime().asSeconds() >= 1.0f) {
+            wavesCheckClock.restart();
+            WaveSet reloaded;
+            if (wavesWatch.changed() && !loadWaves(WAVES_PATH, reloaded, wavesError)) {
+                fprintf(stderr, "%s\n", wavesError.c_str());
+            }
+            else if (!reloaded.waves.empty()) {
+                waves = std::move(reloaded);
+                printf("reloaded %s\n", WAVES_PATH);
+                if (state == GameState::Playing && recordPath != nullptr) {
+                    state = GameState::Restarting;
+                }
+                else if (state == GameState::Playing) {
+                    startWave(world, world.wave);
+                    rewind.clear();
+                    rewind.push(world);
+                }
+            }
+        }
 
-        // Increase difficulty as score increases
-        if (score % 50 == 0 && score > 0) {
-            ENEMY_SPEED += 0.60f;
+        // Start a new game in place; textures, fonts and sounds stay loaded,
+        // but nothing from the last game keeps playing
+        if (state == GameState::Restarting) {
+            sounds.stopAll();
+            if (session) {
+                session->start(world);
+            }
+            else {
+                resetWorld(world);
+            }
+            rewind.clear();
+            rewind.push(world);
+            timestep = FixedTimestep();
+            tickMicros = -1;
+            if (recordPath != nullptr) {
+                beginInputLog(inputLog, world);
+            }
+            state = GameState::Playing;
+            stateTime = 0.0f;
         }
 
-        // Check win condition
-        checkWinCondition(enemies, score, window, scoreText);
+        if (state == GameState::Menu) {
+            if (enterPressed && assetsReady) {
+                state = GameState::Restarting;
+            }
+            else if (escapePressed) {
+                quit = true;
+            }
+        }
+        else if (state == GameState::Playing) {
+            if (session) {
+                savePressed = loadPressed = false;
+                session->poll(world);
+            }
+            if (savePressed && !saveWorldState(QUICKSAVE_PATH, world)) {
+                fprintf(stderr, "could not write %s\n", QUICKSAVE_PATH);
+            }
+            // A loaded state has no input log leading up to it, so loading
+            // is off while recording
+            if (loadPressed && recordPath == nullptr && loadWorldState(QUICKSAVE_PATH, world)) {
+                rewind.clear();
+                rewind.push(world);
+            }
 
-        // Check game over condition
-        checkGameOver(enemies, player, score, window, scoreText);
+            // Step the simulation on a fixed timestep
+            int ticks = timestep.advance(frameDt);
+            for (int t = 0; t < ticks && (session || checkOutcome(world) == Outcome::Playing); ++t) {
+                // Sample the keys right before the tick that uses them
+                {
+                    ScopedTimer timer(&profiler, PHASE_INPUT);
+                    input = readInput();
+                    rewindHeld = !session && sf::Keyboard::isKeyPressed(sf::Keyboard::BackSpace);
+                    inputMicros = appClock.getElapsedTime().asMicroseconds();
+                }
+
+                // Holding Backspace runs time backwards, one tick per tick;
+                // the recording is cut back to match
+                if (rewindHeld) {
+                    rewind.rewind(world, 1);
+                    if (recordPath != nullptr) {
+                        inputLog.inputs.resize(world.tick);
+                    }
+                    continue;
+                }
+
+                // A network tick can be held back to wait for the peer
+                TickEvents events;
+                if (session && !session->advance(world, input, &events)) {
+                    continue;
+                }
+                std::int64_t now = appClock.getElapsedTime().asMicroseconds();
+                if (tickMicros >= 0) {
+                    tickIntervals.add((now - tickMicros) / 1000.0);
+                }
+                tickMicros = now;
+                tickInputMicros = inputMicros;
+
+                if (!session) {
+                    events = stepWorld(world, input);
+                    rewind.push(world);
+                }
+                if (recordPath != nullptr) {
+                    recordInput(inputLog, input);
+                }
+                if (events.shots > 0) {
+                    sounds.trigger(shootEffect);
+                }
+                if (events.hits > 0) {
+                    sounds.trigger(hitEffect);
+                }
+            }
+            sounds.drain();
+
+            // Check win and game over conditions; a network game goes
+            // straight on to the next one
+            ScopedTimer timer(&profiler, PHASE_OUTCOME);
+            Outcome outcome = session ? Outcome::Playing : checkOutcome(world);
+            if (outcome != Outcome::Playing) {
+                state = outcome == Outcome::Won ? GameState::Won : GameState::Lost;
+                stateTime = 0.0f;
+                if (recordPath != nullptr) {
+                    finishInputLog(inputLog, world);
+                    saveInputLog(recordPath, inputLog);
+                }
+            }
+        }
+        else if (state == GameState::Won || state == GameState::Lost) {
+            if (stateTime >= END_SCREEN_SECONDS) {
+                if (enterPressed) {
+                    state = GameState::Restarting;
+                }
+                else if (escapePressed) {
+                    quit = true;
+                }
+            }
+        }
 
-        // Render
-        window.clear();
-        window.draw(background);
-        window.draw(player);
+        // Render: snapshot the frame, then draw it here or hand it to the
+        // render thread (in which case this phase is just the snapshot)
+        {
+            ScopedTimer timer(&profiler, PHASE_RENDER);
+
+            // Re-layout the overlay a few times a second, not every frame
+            if (showProfile && profileRefresh-- <= 0) {
+                profileSummary = profiler.summary();
+                // The render thread owns its pacer's numbers until it stops
+                if (!useRenderThread) {
+                    profileSummary += display.pacer.summary();
+                }
+                ++profileVersion;
+                profileRefresh = 15;
+            }
 
-        for (size_t i = 0; i < bullets.size(); ++i) {
-            window.draw(bullets[i].shape);
+            // Every field is rewritten: buffer slots rotate between frames
+            FrameSnapshot& frame = useRenderThread ? frames.back() : inlineFrame;
+            captureWorld(world, frame);
+            frame.state = state;
+            frame.stateTime = stateTime;
+            frame.assetsReady = assetsReady;
+            frame.tickMicros = tickMicros;
+            frame.inputMicros = tickInputMicros;
+            frame.showProfile = showProfile;
+            frame.profileVersion = profileVersion;
+            frame.profileText = profileSummary;
+
+            if (useRenderThread) {
+                frames.publish();
+            }
+            else {
+                renderClock.restart();
+                int drawCalls = scene.draw(window, frame, timestep.alpha());
+                recordRenderFrame(display.render, drawCalls, scene.pixelsFilled(), renderClock.getElapsedTime());
+            }
+        }
+        if (!useRenderThread) {
+            window.display();
+            recordDisplay(display, inlineFrame, appClock.getElapsedTime().asMicroseconds());
         }
+        profiler.endFrame();
 
-        for (size_t i = 0; i < enemies.size(); ++i) {
-            window.draw(enemies[i].sprite);
+        // Hold until the next frame is due; the render thread paces itself
+        if (useRenderThread) {
+            tickPacer.wait();
+        }
+        else {
+            display.pacer.wait();
         }
+    }
 
-        window.draw(scoreText);
-        window.display();
+    rendering = false;
+    if (renderThread.joinable()) {
+        renderThread.join();
+    }
+    window.close();
+
+    // Keep a game that was quit part way through
+    if (recordPath != nullptr && state == GameState::Playing) {
+        finishInputLog(inputLog, world);
+        saveInputLog(recordPath, inputLog);
     }
 
-    return 0;
-}
\ No newline at end of file
+    printRenderStats(display.render);
+    printFrameTiming(useRenderThread, tickIntervals, display.pacer);
+    if (session) {
+        printNetStats(*session);
+    }
+    return exitCode;
+}
@@ -0,0 +1,85 @@
+#include "grid.h"
+
+#include <algorithm>
+
+SpatialGrid::SpatialGrid(float width, float height, float cellSize)
+    : cellSize(cellSize),
+      cols((int)((width + cellSize - 1) / cellSize)),
+      rows((int)((height + cellSize - 1) / cellSize)),
+      head(cols * rows, -1) {
+}
+
+int SpatialGrid::cellX(float x) const {
+    int c = (int)(x / cellSize);
+    if (x < 0) {
+        c = 0;
+    }
+    return std::min(c, cols - 1);
+}
+
+int SpatialGrid::cellY(float y) const {
+    int r = (int)(y / cellSize);
+    if (y < 0) {
+        r = 0;
+    }
+    return std::min(r, rows - 1);
+}
+
+void SpatialGrid::reset(std::size_t capacity) {
+    std::fill(head.begin(), head.end(), -1);
+    next.assign(capacity, -1);
+    prev.assign(capacity, -1);
+    cell.assign(capacity, -1);
+}
+
+void SpatialGrid::unlink(int id) {
+    if (prev[id] != -1) {
+        next[prev[id]] = next[id];
+    }
+    else {
+        head[cell[id]] = next[id];
+    }
+    if (next[id] != -1) {
+        prev[next[id]] = prev[id];
+    }
+    cell[id] = -1;
+}
+
+void SpatialGrid::link(int id, int cellIndex) {
+    cell[id] = cellIndex;
+    prev[id] = -1;
+    next[id] = head[cellIndex];
+    if (next[id] != -1) {
+        prev[next[id]] = id;
+    }
+    head[cellIndex] = id;
+}
+
+void SpatialGrid::update(int id, float x, float y) {
+    int cellIndex = cellY(y) * cols + cellX(x);
+    if (cell[id] == cellIndex) {
+        return;
+    }
+    if (cell[id] != -1) {
+        unlink(id);
+    }
+    link(id, cellIndex);
+}
+
+void SpatialGrid::remove(int id) {
+    if (cell[id] != -1) {
+        unlink(id);
+    }
+}
+
+void SpatialGrid::rename(int from, int to) {
+    if (to != from && cell[to] != -1) {
+        unlink(to);
+    }
+    if (cell[from] == -1 || from == to) {
+        return;
+    }
+    int cellIndex = cell[from];
+    unlink(from);
+    link(to, cellIndex);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+// Uniform grid over the playfield used as the collision broadphase.
+// Each entity is filed under the cell holding its top-left corner, so a
+// query has to be widened by the largest entity size by the caller.
+// Cells are intrusive doubly linked lists, which makes moving, removing
+// and renumbering an entity O(1) and lets the grid be updated in place
+// every tick instead of rebuilt.
+
+class SpatialGrid {
+public:
+    SpatialGrid(float width, float height, float cellSize);
+
+    // Drops every entity and makes room for ids in [0, capacity)
+    void reset(std::size_t capacity);
+
+    // Files entity `id` under the cell containing (x, y); cheap when the
+    // entity stays in the same cell
+    void update(int id, float x, float y);
+    void remove(int id);
+    // Entity `from` is now known as `to` (after compaction)
+    void rename(int from, int to);
+    bool contains(int id) const { return cell[id] != -1; }
+
+    // Calls visit(id) for each entity filed in a cell overlapping the box
+    template <typename Visit>
+    void query(float left, float top, float right, float bottom, Visit visit) const {
+        int c0 = cellX(left), c1 = cellX(right);
+        int r0 = cellY(top), r1 = cellY(bottom);
+        for (int r = r0; r <= r1; ++r) {
+            for (int c = c0; c <= c1; ++c) {
+                for (int id = head[r * cols + c]; id != -1; id = next[id]) {
+                    visit(id);
+                }
+            }
+        }
+    }
+
+private:
+    int cellX(float x) const;
+    int cellY(float y) const;
+    void unlink(int id);
+    void link(int id, int cellIndex);
+
+    float cellSize;
+    int cols, rows;
+    std::vector<int> head;
+    std::vector<int> next, prev, cell;
+};
@@ -0,0 +1,408 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "netplay.h"
+#include "replay.h"
+#include "rewind.h"
+#include "waves.h"
+#include "world.h"
+
+// Headless driver: steps the simulation as fast as possible with no window.
+// Usage: headless [--ticks N] [--seed N] [--tuning NAME] [--bullet-capacity N]
+//                 [--check-allocs] [--check-rewind] [--waves FILE]
+//                 [--record FILE] [--replay FILE]...
+//        headless --player 0|1 --port N --peer HOST:PORT [--ticks N] [--seed N]
+//                 [--tuning NAME] [--input-delay N] [--rtt MS] [--jitter MS]
+//                 [--loss PERCENT]
+//
+// --check-allocs holds fire for the whole run and fails if any heap
+// allocation happens after the world has been set up.
+// --check-rewind keeps a rewind buffer and every 600 ticks rewinds 2
+// seconds, replays the same inputs and fails if the state hash differs.
+// --seed seeds the random player and the games: game k of the run is
+// played on seed + k, which its replay log records.
+// --tuning picks classic (the default), dense or stress; see tuning.h.
+// --bullet-capacity overrides the tuning's bullet pool size.
+// --waves plays the waves from FILE instead of the tuning's built-in ones.
+// --record saves the inputs of the first game as a replay log.
+// --replay re-runs each recorded log uncapped and fails if any final
+// state hash differs from the recorded one. Each log is replayed under
+// the tuning it was recorded with.
+// --player runs one side of a two-player network game instead, in real
+// time at 60 ticks/sec with random input, against another headless
+// process started with the other player number and the same --ticks,
+// --tuning and --input-delay. --rtt, --jitter and --loss shape this side's
+// sends; the round trip is the two sides' --rtt averaged. Both sides print
+// the hash of the state at the last tick, which must match.
+
+static long long allocationCount = 0;
+
+void* operator new(std::size_t size) {
+    ++allocationCount;
+    if (void* p = std::malloc(size ? size : 1)) {
+        return p;
+    }
+    throw std::bad_alloc();
+}
+
+void* operator new[](std::size_t size) {
+    return operator new(size);
+}
+
+void operator delete(void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p) noexcept {
+    std::free(p);
+}
+
+void operator delete(void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+void operator delete[](void* p, std::size_t) noexcept {
+    std::free(p);
+}
+
+static std::uint32_t nextRandom(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+const std::uint32_t REWIND_CHECK_INTERVAL = 600;
+const std::size_t REWIND_CHECK_TICKS = 120;
+
+// Goes back REWIND_CHECK_TICKS ticks and steps forward again with the
+// same inputs; the world must end up exactly where it was
+static bool checkRewind(World& world, RewindBuffer& buffer, const std::uint8_t* history) {
+    std::uint64_t expected = hashWorld(world);
+    std::uint32_t tick = world.tick;
+    if (!buffer.rewind(world, REWIND_CHECK_TICKS) || world.tick != tick - REWIND_CHECK_TICKS) {
+        return false;
+    }
+    while (world.tick < tick) {
+        stepWorld(world, history[world.tick % 256]);
+        buffer.push(world);
+    }
+    return hashWorld(world) == expected;
+}
+
+// `fileWaves` is null when no --waves file was given
+static int runReplays(const std::vector<const char*>& paths, const WaveSet* fileWaves) {
+    int failures = 0;
+    for (const char* path : paths) {
+        InputLog log;
+        if (!loadInputLog(path, log)) {
+            std::fprintf(stderr, "%s: not a readable replay log\n", path);
+            ++failures;
+            continue;
+        }
+
+        const WaveSet& waves = fileWaves != nullptr ? *fileWaves : defaultWaves(log.tuning);
+        if (log.wavesHash != hashWaves(waves)) {
+            std::fprintf(stderr, "%s: recorded with different waves (use --waves)\n", path);
+            ++failures;
+            continue;
+        }
+
+        World world;
+        world.waves = &waves;
+        auto start = std::chrono::steady_clock::now();
+        bool matched = replayInputLog(log, world);
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+        std::printf("%s: %s, %zu ticks, score %d, %s (%.0f ticks/sec)\n", path, tuningName(log.tuning),
+                    log.inputs.size(), world.score, matched ? "ok" : "HASH MISMATCH",
+                    seconds > 0 ? log.inputs.size() / seconds : 0.0);
+        failures += !matched;
+    }
+    return failures == 0 ? 0 : 1;
+}
+
+struct NetRunConfig {
+    int player = -1; // not a network run
+    int port = 0;
+    const char* peer = nullptr;
+    std::uint32_t inputDelay = 2;
+    LinkShim shim;
+};
+
+// One side of a network game, paced in real time; see the usage notes
+static int runNetplay(const NetRunConfig& config, TuningId tuning, const WaveSet& waves, long long totalTicks,
+                      std::uint32_t seed) {
+    World world;
+    setTuning(world, tuning);
+    world.waves = &waves;
+    NetSession session(config.player, config.inputDelay);
+    std::string error;
+    if (!session.open(config.port, config.peer, config.shim, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    session.start(world);
+    std::uint32_t end = (std::uint32_t)std::max(totalTicks, 1LL);
+
+    // Different random input per player, the same on every run
+    std::uint32_t rng = seed + (std::uint32_t)config.player * 0x9E3779B9u;
+    if (rng == 0) {
+        rng = 1;
+    }
+    std::uint8_t input = 0;
+
+    using Clock = std::chrono::steady_clock;
+    const auto tickLength = std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(TICK_DT));
+    auto start = Clock::now();
+    auto nextTick = start;
+    auto lastProgress = start;
+    std::uint32_t lastConfirmed = 0;
+    while (!session.settled(end)) {
+        session.poll(world);
+        auto now = Clock::now();
+        if (session.confirmedTick() != lastConfirmed) {
+            lastConfirmed = session.confirmedTick();
+            lastProgress = now;
+        }
+        else if (now - lastProgress > std::chrono::seconds(10)) {
+            std::fprintf(stderr, "FAIL: no input from the peer for 10 seconds (tick %u)\n", session.tick());
+            return 1;
+        }
+        if (now >= nextTick) {
+            nextTick += tickLength;
+            if (session.tick() < end) {
+                if (session.tick() % 8 == 0) {
+                    input = (std::uint8_t)(nextRandom(rng) & (INPUT_LEFT | INPUT_RIGHT | INPUT_FIRE));
+                }
+                session.advance(world, input);
+            }
+        }
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    double seconds = std::chrono::duration<double>(Clock::now() - start).count();
+
+    // Keep answering for a moment, so the peer hears it has everything
+    auto linger = Clock::now() + std::chrono::milliseconds(500);
+    while (Clock::now() < linger) {
+        session.poll(world);
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+
+    std::printf("player: %d, tuning: %s, input delay: %u ticks\n", config.player, tuningName(tuning),
+                config.inputDelay);
+    std::printf("link: %.0f ms one way, %.0f ms jitter, %.1f%% loss\n", config.shim.delayMs, config.shim.jitterMs,
+                config.shim.loss * 100.0f);
+    std::printf("ticks: %u in %.2f s\n", session.tick(), seconds);
+    printNetStats(session);
+    std::printf("final hash: %016llx\n", (unsigned long long)hashWorld(world));
+    if (session.stats().desyncs > 0) {
+        std::fprintf(stderr, "FAIL: %lld sync checks disagreed with the peer\n", session.stats().desyncs);
+        return 1;
+    }
+    return 0;
+}
+
+int main(int argc, char** argv) {
+    long long totalTicks = 100000;
+    std::uint32_t seed = 1;
+    TuningId tuning = TuningId::Classic;
+    long long bulletCapacity = -1; // the tuning's
+    bool checkAllocs = false;
+    bool rewinding = false;
+    const char* recordPath = nullptr;
+    const char* wavesPath = nullptr;
+    std::vector<const char*> replayPaths;
+    NetRunConfig net;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--ticks") == 0 && i + 1 < argc) {
+            totalTicks = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            seed = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--tuning") == 0 && i + 1 < argc) {
+            if (!findTuning(argv[++i], tuning)) {
+                std::fprintf(stderr, "unknown tuning: %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--bullet-capacity") == 0 && i + 1 < argc) {
+            bulletCapacity = std::atoll(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--check-allocs") == 0) {
+            checkAllocs = true;
+        }
+        else if (std::strcmp(argv[i], "--check-rewind") == 0) {
+            rewinding = true;
+        }
+        else if (std::strcmp(argv[i], "--waves") == 0 && i + 1 < argc) {
+            wavesPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            recordPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            replayPaths.push_back(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--player") == 0 && i + 1 < argc) {
+            net.player = std::atoi(argv[++i]) != 0 ? 1 : 0;
+        }
+        else if (std::strcmp(argv[i], "--port") == 0 && i + 1 < argc) {
+            net.port = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--peer") == 0 && i + 1 < argc) {
+            net.peer = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--input-delay") == 0 && i + 1 < argc) {
+            net.inputDelay = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--rtt") == 0 && i + 1 < argc) {
+            net.shim.delayMs = (float)std::atof(argv[++i]) * 0.5f;
+        }
+        else if (std::strcmp(argv[i], "--jitter") == 0 && i + 1 < argc) {
+            net.shim.jitterMs = (float)std::atof(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--loss") == 0 && i + 1 < argc) {
+            net.shim.loss = (float)std::atof(argv[++i]) / 100.0f;
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--ticks N] [--seed N] [--tuning NAME] [--bullet-capacity N]\n"
+                                 "       [--check-allocs] [--check-rewind] [--waves FILE]\n"
+                                 "       [--record FILE] [--replay FILE]...\n"
+                                 "   or: %s --player 0|1 --port N --peer HOST:PORT [--ticks N] [--seed N]\n"
+                                 "       [--tuning NAME] [--input-delay N] [--rtt MS] [--jitter MS] [--loss PERCENT]\n",
+                         argv[0], argv[0]);
+            return 2;
+        }
+    }
+
+    WaveSet waves = defaultWaves(tuning);
+    std::string error;
+    if (wavesPath != nullptr && !loadWaves(wavesPath, waves, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    if (!replayPaths.empty()) {
+        return runReplays(replayPaths, wavesPath != nullptr ? &waves : nullptr);
+    }
+    if (seed == 0) {
+        seed = 1;
+    }
+    if (net.player >= 0) {
+        if (net.peer == nullptr || net.port <= 0) {
+            std::fprintf(stderr, "--player needs --port and --peer\n");
+            return 2;
+        }
+        return runNetplay(net, tuning, waves, totalTicks, seed);
+    }
+
+    World world;
+    setTuning(world, tuning);
+    world.waves = &waves;
+    if (bulletCapacity >= 0) {
+        world.bulletCapacity = (std::size_t)std::max(bulletCapacity, 1LL);
+    }
+    resetWorld(world, seed);
+
+    // Ten seconds of history, with inputs kept for replaying after a rewind
+    RewindBuffer rewind(600, 4 << 20);
+    std::uint8_t history[256];
+    int rewindChecks = 0, rewindFailures = 0;
+    if (rewinding) {
+        rewind.push(world);
+    }
+
+    InputLog log;
+    bool recording = recordPath != nullptr;
+    if (recording) {
+        beginInputLog(log, world);
+        log.inputs.reserve((std::size_t)totalTicks);
+    }
+
+    int games = 0, wins = 0;
+    long long scoreSum = 0;
+    std::uint32_t rng = seed;
+    std::uint8_t input = 0;
+
+    long long allocationsBefore = allocationCount;
+    auto start = std::chrono::steady_clock::now();
+    for (long long t = 0; t < totalTicks; ++t) {
+        // Hold each random input for a few ticks, like a player would
+        if (t % 8 == 0) {
+            input = (std::uint8_t)(nextRandom(rng) & (INPUT_LEFT | INPUT_RIGHT | INPUT_FIRE));
+            if (checkAllocs) {
+                input |= INPUT_FIRE;
+            }
+        }
+        history[world.tick % 256] = input;
+        stepWorld(world, input);
+        if (recording) {
+            recordInput(log, input);
+        }
+        if (rewinding) {
+            rewind.push(world);
+            if (world.tick % REWIND_CHECK_INTERVAL == 0) {
+                ++rewindChecks;
+                rewindFailures += !checkRewind(world, rewind, history);
+            }
+        }
+
+        Outcome outcome = checkOutcome(world);
+        if (recording && (outcome != Outcome::Playing || t + 1 == totalTicks)) {
+            finishInputLog(log, world);
+            recording = false;
+        }
+        if (outcome != Outcome::Playing) {
+            ++games;
+            wins += outcome == Outcome::Won;
+            scoreSum += world.score;
+            resetWorld(world, seed + (std::uint32_t)games);
+            if (rewinding) {
+                rewind.clear();
+                rewind.push(world);
+            }
+        }
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    long long allocations = allocationCount - allocationsBefore;
+
+    std::printf("tuning: %s\n", tuningName(tuning));
+    std::printf("ticks: %lld\n", totalTicks);
+    std::printf("games: %d (won %d)\n", games, wins);
+    std::printf("average score: %.1f\n", games > 0 ? (double)scoreSum / games : (double)world.score);
+    std::printf("elapsed: %.3f s\n", seconds);
+    std::printf("ticks/sec: %.0f\n", seconds > 0 ? totalTicks / seconds : 0.0);
+    std::printf("heap allocations: %lld\n", allocations);
+    if (rewinding) {
+        std::printf("rewind checks: %d (%d failed), %zu snapshots in %zu KB (%zu KB uncompressed)\n", rewindChecks,
+                    rewindFailures, rewind.size(), rewind.bytesUsed() / 1024, rewind.rawBytes() / 1024);
+    }
+
+    if (recordPath != nullptr) {
+        if (!saveInputLog(recordPath, log)) {
+            std::fprintf(stderr, "could not write %s\n", recordPath);
+            return 1;
+        }
+        std::printf("recorded %zu ticks to %s\n", log.inputs.size(), recordPath);
+    }
+
+    if (rewindFailures > 0) {
+        std::fprintf(stderr, "FAIL: %d rewinds did not replay to the same state\n", rewindFailures);
+        return 1;
+    }
+    if (checkAllocs && allocations != 0) {
+        std::fprintf(stderr, "FAIL: %lld heap allocations in steady state\n", allocations);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,126 @@
+#include "layers.h"
+
+#include <algorithm>
+
+const int VERTICES_PER_GLYPH = 6;
+const int MAX_DIGITS = 10;
+
+sf::RenderTarget* CachedLayer::begin(unsigned width, unsigned height) {
+    if (failed) {
+        return nullptr;
+    }
+    if (!created || texture.getSize().x != width || texture.getSize().y != height) {
+        created = texture.create(width, height);
+        if (!created) {
+            failed = true;
+            return nullptr;
+        }
+        sprite.setTexture(texture.getTexture(), true);
+    }
+    texture.clear();
+    return &texture;
+}
+
+void CachedLayer::end() {
+    texture.display();
+    valid = true;
+}
+
+int CachedLayer::composite(sf::RenderTarget& target) const {
+    // Opaque and full-size, so there is nothing underneath to blend with
+    target.draw(sprite, sf::RenderStates(sf::BlendNone));
+    return 1;
+}
+
+// Writes one glyph as two triangles with its top-left pen offset at (x, y)
+static void writeGlyph(sf::Vertex* v, float x, float y, const sf::FloatRect& bounds, const sf::FloatRect& texture) {
+    float left = x + bounds.left, top = y + bounds.top;
+    float right = left + bounds.width, bottom = top + bounds.height;
+    float u1 = texture.left, v1 = texture.top;
+    float u2 = u1 + texture.width, v2 = v1 + texture.height;
+
+    v[0] = sf::Vertex({ left, top }, sf::Color::White, { u1, v1 });
+    v[1] = sf::Vertex({ right, top }, sf::Color::White, { u2, v1 });
+    v[2] = sf::Vertex({ right, bottom }, sf::Color::White, { u2, v2 });
+    v[3] = sf::Vertex({ left, top }, sf::Color::White, { u1, v1 });
+    v[4] = sf::Vertex({ right, bottom }, sf::Color::White, { u2, v2 });
+    v[5] = sf::Vertex({ left, bottom }, sf::Color::White, { u1, v2 });
+}
+
+CounterText::CounterText(const sf::Font& font, unsigned characterSize, const std::string& label)
+    : font(font), characterSize(characterSize),
+      vertices(sf::Triangles, (label.size() + MAX_DIGITS) * VERTICES_PER_GLYPH) {
+    for (int d = 0; d < 10; ++d) {
+        digits[d] = layoutGlyph('0' + d);
+    }
+
+    // Lay the label out on the baseline the way sf::Text does, kerning
+    // included; whitespace only advances the pen
+    float x = 0.0f, y = (float)characterSize;
+    sf::Uint32 previous = 0;
+    for (char c : label) {
+        sf::Uint32 current = (unsigned char)c;
+        x += font.getKerning(previous, current, characterSize);
+        previous = current;
+
+        GlyphQuad glyph = layoutGlyph(current);
+        if (c != ' ') {
+            writeGlyph(&vertices[labelVertices], x, y, glyph.bounds, glyph.texture);
+            labelVertices += VERTICES_PER_GLYPH;
+            labelArea += glyph.bounds.width * glyph.bounds.height;
+        }
+        x += glyph.advance;
+    }
+    labelWidth = x;
+    setValue(0);
+}
+
+CounterText::GlyphQuad CounterText::layoutGlyph(sf::Uint32 character) const {
+    // One pixel of padding on each side keeps the antialiased edges, as
+    // sf::Text does
+    const sf::Glyph& glyph = font.getGlyph(character, characterSize, false);
+    GlyphQuad quad;
+    quad.bounds = sf::FloatRect(glyph.bounds.left - 1, glyph.bounds.top - 1, glyph.bounds.width + 2,
+                                glyph.bounds.height + 2);
+    quad.texture = sf::FloatRect((float)glyph.textureRect.left - 1, (float)glyph.textureRect.top - 1,
+                                 (float)glyph.textureRect.width + 2, (float)glyph.textureRect.height + 2);
+    quad.advance = glyph.advance;
+    return quad;
+}
+
+void CounterText::setPosition(float x, float y) {
+    position = sf::Vector2f(x, y);
+}
+
+void CounterText::setValue(int newValue) {
+    newValue = std::max(0, newValue);
+    if (newValue == value) {
+        return;
+    }
+    value = newValue;
+
+    int reversed[MAX_DIGITS];
+    int count = 0;
+    do {
+        reversed[count++] = newValue % 10;
+        newValue /= 10;
+    } while (newValue > 0);
+
+    float x = labelWidth, y = (float)characterSize;
+    quadArea = labelArea;
+    vertexCount = labelVertices;
+    for (int i = count - 1; i >= 0; --i) {
+        const GlyphQuad& glyph = digits[reversed[i]];
+        writeGlyph(&vertices[vertexCount], x, y, glyph.bounds, glyph.texture);
+        vertexCount += VERTICES_PER_GLYPH;
+        quadArea += glyph.bounds.width * glyph.bounds.height;
+        x += glyph.advance;
+    }
+}
+
+int CounterText::draw(sf::RenderTarget& target) const {
+    sf::RenderStates states(&font.getTexture(characterSize));
+    states.transform.translate(position);
+    target.draw(&vertices[0], vertexCount, sf::Triangles, states);
+    return 1;
+}
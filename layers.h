@@ -0,0 +1,71 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include <string>
+
+// Drawing for the parts of a frame that rarely change: a layer cached in
+// an offscreen texture, and a counter laid out from preformatted glyphs.
+
+// A full-target layer drawn into its own texture only when invalidated.
+// It is composited with one unblended quad, which also stands in for
+// clearing the frame, so the layer must cover the whole target.
+class CachedLayer {
+public:
+    bool dirty() const { return !valid; }
+    void invalidate() { valid = false; }
+
+    // Returns the cleared texture to redraw the layer into, or null if no
+    // offscreen texture can be created (the caller then draws directly)
+    sf::RenderTarget* begin(unsigned width, unsigned height);
+    void end();
+
+    // Draws the cached layer over the whole target; returns the draw calls
+    int composite(sf::RenderTarget& target) const;
+
+private:
+    sf::RenderTexture texture;
+    sf::Sprite sprite;
+    bool created = false, failed = false, valid = false;
+};
+
+// A label followed by a non-negative number, e.g. "Score: 120". The label
+// and the digits 0-9 are looked up in the font once; changing the value
+// only rewrites the digit quads, with no string building or text layout.
+class CounterText {
+public:
+    CounterText(const sf::Font& font, unsigned characterSize, const std::string& label);
+
+    // Places the text's top-left corner as sf::Text::setPosition would
+    void setPosition(float x, float y);
+
+    // Rewrites the digits if `value` differs from the one shown
+    void setValue(int value);
+
+    int draw(sf::RenderTarget& target) const;
+
+    // Area covered by the glyph quads, in pixels
+    float area() const { return quadArea; }
+
+private:
+    struct GlyphQuad {
+        sf::FloatRect bounds;
+        sf::FloatRect texture;
+        float advance;
+    };
+
+    GlyphQuad layoutGlyph(sf::Uint32 character) const;
+
+    const sf::Font& font;
+    unsigned characterSize;
+    GlyphQuad digits[10];
+
+    // The label's quads come first and are written once
+    sf::VertexArray vertices;
+    std::size_t labelVertices = 0, vertexCount = 0;
+    float labelWidth = 0.0f, labelArea = 0.0f;
+
+    sf::Vector2f position;
+    int value = -1;
+    float quadArea = 0.0f;
+};
@@ -0,0 +1,59 @@
+#include "mask.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+
+// How far (per channel) a pixel may be from the background key and still
+// count as background; the sprites' backgrounds aren't perfectly flat
+const int KEY_TOLERANCE = 24;
+
+void buildSpriteMask(const std::uint8_t* rgba, int width, int height, SpriteMask& mask) {
+    mask.width = width;
+    mask.height = height;
+    mask.wordsPerRow = (width + 63) / 64;
+    mask.bits.assign((std::size_t)mask.wordsPerRow * height, 0);
+
+    bool keyed = width > 0 && height > 0 && rgba[3] >= 128;
+    for (int y = 0; y < height; ++y) {
+        for (int x = 0; x < width; ++x) {
+            const std::uint8_t* p = rgba + ((std::size_t)y * width + x) * 4;
+            bool solid = p[3] >= 128;
+            if (solid && keyed) {
+                int diff = std::max({ std::abs(p[0] - rgba[0]), std::abs(p[1] - rgba[1]), std::abs(p[2] - rgba[2]) });
+                solid = diff > KEY_TOLERANCE;
+            }
+            if (solid) {
+                mask.bits[(std::size_t)y * mask.wordsPerRow + x / 64] |= (std::uint64_t)1 << (x % 64);
+            }
+        }
+    }
+}
+
+bool maskOverlapsRect(const SpriteMask& mask, float mx, float my, float mw, float mh,
+                      float rx, float ry, float rw, float rh) {
+    // The overlap in mask pixels; a partly covered pixel counts
+    float sx = mask.width / mw, sy = mask.height / mh;
+    int x0 = std::max(0, (int)std::floor((std::max(rx, mx) - mx) * sx));
+    int x1 = std::min(mask.width, (int)std::ceil((std::min(rx + rw, mx + mw) - mx) * sx));
+    int y0 = std::max(0, (int)std::floor((std::max(ry, my) - my) * sy));
+    int y1 = std::min(mask.height, (int)std::ceil((std::min(ry + rh, my + mh) - my) * sy));
+    if (x0 >= x1 || y0 >= y1) {
+        return false;
+    }
+
+    // The columns are the same in every row: build each word's span once,
+    // then AND it down the rows
+    for (int k = x0 / 64; k <= (x1 - 1) / 64; ++k) {
+        int lo = std::max(x0, k * 64) - k * 64;
+        int hi = std::min(x1, k * 64 + 64) - k * 64;
+        std::uint64_t span = hi - lo == 64 ? ~(std::uint64_t)0 : (((std::uint64_t)1 << (hi - lo)) - 1) << lo;
+        const std::uint64_t* word = &mask.bits[(std::size_t)y0 * mask.wordsPerRow + k];
+        for (int y = y0; y < y1; ++y, word += mask.wordsPerRow) {
+            if (*word & span) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+// 1-bit collision masks for sprites: one bit per pixel, each row packed
+// into 64-bit words (bit 0 is the leftmost pixel of a word). Tests run a
+// word at a time, and only on pairs the bounding boxes already accepted.
+
+struct SpriteMask {
+    int width = 0, height = 0;
+    int wordsPerRow = 0;
+    std::vector<std::uint64_t> bits;
+
+    bool empty() const { return bits.empty(); }
+    bool test(int x, int y) const { return (bits[y * wordsPerRow + x / 64] >> (x % 64)) & 1; }
+};
+
+// Builds a mask from RGBA pixels. A pixel is solid if it is at least half
+// opaque and, when the top-left pixel is opaque, doesn't match that pixel's
+// color: sprites without an alpha channel (like enemy.png) get their flat
+// background keyed out instead.
+void buildSpriteMask(const std::uint8_t* rgba, int width, int height, SpriteMask& mask);
+
+// True if a solid pixel of the mask, drawn at (mx, my) stretched to
+// mw x mh, lies inside the rectangle (rx, ry, rw, rh)
+bool maskOverlapsRect(const SpriteMask& mask, float mx, float my, float mw, float mh,
+                      float rx, float ry, float rw, float rh);
@@ -0,0 +1,280 @@
+#include "netplay.h"
+
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+#include "replay.h"
+
+static const char NET_MAGIC[4] = { 'S', 'W', 'N', 'P' };
+static const std::size_t NET_HEADER_SIZE = 31;
+static const std::uint32_t MAX_INPUTS_PER_DATAGRAM = 64;
+
+// Rollbacks go at most NET_MAX_PREDICTION ticks deep; keyframes every few
+// ticks keep a restore down to a handful of deltas
+static const std::size_t HISTORY_TICKS = 4 * NET_MAX_PREDICTION;
+static const std::size_t HISTORY_BYTES = 4 << 20;
+static const std::size_t HISTORY_KEYFRAME_INTERVAL = 4;
+
+static const std::uint8_t PLAYER_BITS = INPUT_LEFT | INPUT_RIGHT | INPUT_FIRE;
+
+static void putBytes(std::uint8_t*& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        *out++ = (std::uint8_t)(value >> (8 * i));
+    }
+}
+
+static std::uint64_t getBytes(const std::uint8_t*& in, int bytes) {
+    std::uint64_t value = 0;
+    for (int i = 0; i < bytes; ++i) {
+        value |= (std::uint64_t)*in++ << (8 * i);
+    }
+    return value;
+}
+
+TickEvents netStep(World& world, std::uint8_t input) {
+    if (checkOutcome(world) != Outcome::Playing) {
+        resetWorld(world, world.seed + 1);
+        return TickEvents();
+    }
+    return stepWorld(world, input);
+}
+
+NetSession::NetSession(int player, std::uint32_t inputDelay)
+    : player(player != 0 ? 1 : 0), inputDelay(std::min(inputDelay, RING / 4)),
+      history(HISTORY_TICKS, HISTORY_BYTES, HISTORY_KEYFRAME_INTERVAL) {
+}
+
+bool NetSession::open(int localPort, const char* address, const LinkShim& shim, std::string& error) {
+    if (!peer.open(localPort, address, error)) {
+        return false;
+    }
+    peer.setShim(shim, 0x5EED + (std::uint32_t)player);
+    return true;
+}
+
+void NetSession::start(World& world) {
+    world.players = 2;
+    resetWorld(world);
+    history.clear();
+    history.push(world);
+
+    // Nothing is pressed during the first inputDelay ticks
+    std::memset(localInputs, 0, sizeof(localInputs));
+    now = 0;
+    localCount = inputDelay;
+    remoteCount = 0;
+    peerAck = 0;
+    peerTick = 0;
+    peerAdvantage = 0;
+    waitTicks = 0;
+    nextTimeSync = NET_SYNC_INTERVAL;
+    sentTick = 0;
+    sentAt = std::chrono::steady_clock::time_point();
+    std::memset(syncTicks, 0, sizeof(syncTicks));
+    peerSyncTick = 0;
+    lastChecked = 0;
+    counters = NetStats();
+}
+
+// The peer's input for tick t, or the guess for it: the last one received
+std::uint8_t NetSession::remoteInput(std::uint32_t t) const {
+    if (t < remoteCount) {
+        return remoteInputs[t % RING];
+    }
+    return remoteCount > 0 ? remoteInputs[(remoteCount - 1) % RING] : 0;
+}
+
+std::uint8_t NetSession::combined(std::uint32_t t, std::uint8_t remote) const {
+    std::uint8_t local = localInputs[t % RING];
+    return player == 0 ? (std::uint8_t)(local | remote << INPUT_P2_SHIFT)
+                       : (std::uint8_t)(remote | local << INPUT_P2_SHIFT);
+}
+
+void NetSession::simulate(World& world, std::uint32_t t, TickEvents* events) {
+    std::uint8_t remote = remoteInput(t);
+    usedInputs[t % RING] = remote;
+    TickEvents tickEvents = netStep(world, combined(t, remote));
+    if (events != nullptr) {
+        *events = tickEvents;
+    }
+    history.push(world);
+
+    // Only final once every input before it is confirmed; a rollback
+    // through here rewrites it first
+    std::uint32_t after = t + 1;
+    if (after % NET_SYNC_INTERVAL == 0) {
+        std::uint32_t slot = after / NET_SYNC_INTERVAL % SYNC_SLOTS;
+        syncTicks[slot] = after;
+        syncHashes[slot] = hashWorld(world);
+    }
+}
+
+bool NetSession::advance(World& world, std::uint8_t input, TickEvents* events) {
+    if (now >= remoteCount + NET_MAX_PREDICTION) {
+        ++counters.stalls;
+        return false;
+    }
+    if (waitTicks > 0) {
+        --waitTicks;
+        ++counters.waits;
+        return false;
+    }
+    localInputs[localCount % RING] = input & PLAYER_BITS;
+    ++localCount;
+    simulate(world, now, events);
+    ++now;
+    ++counters.ticks;
+    return true;
+}
+
+void NetSession::poll(World& world) {
+    peer.flush();
+    receive(world);
+    checkSync();
+
+    // Time sync: both peers see the other's tick one trip late, so the
+    // difference between the two advantages is how far this one leads
+    if (counters.datagramsReceived > 0 && now >= nextTimeSync && waitTicks == 0) {
+        int advantage = (int)now - (int)peerTick;
+        int lead = (advantage - peerAdvantage) / 2;
+        waitTicks = (std::uint32_t)std::max(0, std::min(lead, (int)NET_MAX_PREDICTION));
+        nextTimeSync = now + NET_SYNC_INTERVAL;
+    }
+
+    auto clock = std::chrono::steady_clock::now();
+    if (now != sentTick || clock - sentAt >= std::chrono::milliseconds(NET_RESEND_MS)) {
+        send();
+        sentTick = now;
+        sentAt = clock;
+    }
+}
+
+void NetSession::receive(World& world) {
+    std::uint8_t data[UdpPeer::MAX_DATAGRAM];
+    std::uint32_t mismatch = now;
+    std::size_t size;
+    while ((size = peer.receive(data, sizeof(data))) > 0) {
+        if (size < NET_HEADER_SIZE || std::memcmp(data, NET_MAGIC, 4) != 0 || data[4] != 1 - player) {
+            continue;
+        }
+        const std::uint8_t* in = data + 5;
+        std::uint32_t tick = (std::uint32_t)getBytes(in, 4);
+        std::uint32_t ack = (std::uint32_t)getBytes(in, 4);
+        int advantage = (std::int8_t)getBytes(in, 1);
+        std::uint32_t syncTick = (std::uint32_t)getBytes(in, 4);
+        std::uint64_t syncHash = getBytes(in, 8);
+        std::uint32_t first = (std::uint32_t)getBytes(in, 4);
+        std::uint32_t count = (std::uint32_t)getBytes(in, 1);
+        if (size < NET_HEADER_SIZE + count) {
+            continue;
+        }
+        ++counters.datagramsReceived;
+
+        // Datagrams can arrive out of order; only newer news counts
+        if (tick >= peerTick) {
+            peerTick = tick;
+            peerAdvantage = advantage;
+        }
+        peerAck = std::max(peerAck, std::min(ack, localCount));
+        if (syncTick > peerSyncTick) {
+            peerSyncTick = syncTick;
+            peerSyncHash = syncHash;
+        }
+
+        // Take the inputs that extend the ones held without a gap
+        for (std::uint32_t i = 0; i < count; ++i) {
+            std::uint32_t t = first + i;
+            if (t < remoteCount) {
+                continue;
+            }
+            if (t > remoteCount || t >= now + RING / 2) {
+                break;
+            }
+            std::uint8_t value = in[i] & PLAYER_BITS;
+            remoteInputs[t % RING] = value;
+            if (t < now && usedInputs[t % RING] != value) {
+                ++counters.mispredicted;
+                mismatch = std::min(mismatch, t);
+            }
+            ++remoteCount;
+        }
+    }
+    if (mismatch < now) {
+        rollback(world, mismatch);
+    }
+}
+
+// Back to the state before tick `from`, then forward again to the present
+void NetSession::rollback(World& world, std::uint32_t from) {
+    auto start = std::chrono::steady_clock::now();
+    std::uint32_t target = now;
+    if (!history.rewind(world, now - from)) {
+        return;
+    }
+    for (std::uint32_t t = from; t < target; ++t) {
+        simulate(world, t, nullptr);
+    }
+    double micros = std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    ++counters.rollbacks;
+    counters.resimulatedTicks += target - from;
+    counters.resimMicros.add(micros);
+}
+
+// Compares the peer's newest checkpoint with this side's, once both are final
+void NetSession::checkSync() {
+    if (peerSyncTick <= lastChecked || peerSyncTick > confirmedTick()) {
+        return;
+    }
+    std::uint32_t slot = peerSyncTick / NET_SYNC_INTERVAL % SYNC_SLOTS;
+    if (syncTicks[slot] == peerSyncTick) {
+        ++counters.syncChecks;
+        counters.desyncs += syncHashes[slot] != peerSyncHash;
+    }
+    lastChecked = peerSyncTick;
+}
+
+void NetSession::send() {
+    std::uint8_t data[NET_HEADER_SIZE + MAX_INPUTS_PER_DATAGRAM];
+    std::uint8_t* out = data;
+    std::memcpy(out, NET_MAGIC, 4);
+    out += 4;
+    *out++ = (std::uint8_t)player;
+    putBytes(out, now, 4);
+    putBytes(out, remoteCount, 4);
+    int advantage = std::max(-127, std::min(127, (int)now - (int)peerTick));
+    putBytes(out, (std::uint8_t)(std::int8_t)advantage, 1);
+
+    // The newest checkpoint that can't change any more
+    std::uint32_t syncTick = confirmedTick() / NET_SYNC_INTERVAL * NET_SYNC_INTERVAL;
+    std::uint32_t slot = syncTick / NET_SYNC_INTERVAL % SYNC_SLOTS;
+    bool final = syncTick > 0 && syncTicks[slot] == syncTick;
+    putBytes(out, final ? syncTick : 0, 4);
+    putBytes(out, final ? syncHashes[slot] : 0, 8);
+
+    // Everything the peer doesn't have yet, oldest first
+    std::uint32_t count = std::min(localCount - peerAck, MAX_INPUTS_PER_DATAGRAM);
+    putBytes(out, peerAck, 4);
+    putBytes(out, count, 1);
+    for (std::uint32_t i = 0; i < count; ++i) {
+        *out++ = localInputs[(peerAck + i) % RING];
+    }
+    peer.send(data, (std::size_t)(out - data));
+}
+
+void printNetStats(const NetSession& session) {
+    const NetStats& stats = session.stats();
+    const UdpPeer& link = session.link();
+    double ticks = stats.ticks > 0 ? (double)stats.ticks : 1.0;
+    // 28 bytes of IPv4 and UDP headers ride on every datagram
+    std::printf("sent: %lld datagrams (%lld dropped), %.1f bytes/tick payload, %.1f with UDP/IP headers\n",
+                link.datagramsSent, link.datagramsDropped, link.bytesSent / ticks,
+                (link.bytesSent + 28.0 * link.datagramsSent) / ticks);
+    std::printf("received: %lld datagrams\n", stats.datagramsReceived);
+    std::printf("mispredicted inputs: %lld\n", stats.mispredicted);
+    std::printf("rollbacks: %lld (%.3f/tick), %.2f ticks resimulated on average\n", stats.rollbacks,
+                stats.rollbacks / ticks, stats.rollbacks > 0 ? (double)stats.resimulatedTicks / stats.rollbacks : 0.0);
+    std::printf("rollback cost: %.1f us mean, %.1f us max\n", stats.resimMicros.mean(), stats.resimMicros.max);
+    std::printf("stalls: %lld, waits: %lld\n", stats.stalls, stats.waits);
+    std::printf("sync checks: %lld (%lld desynced)\n", stats.syncChecks, stats.desyncs);
+}
@@ -0,0 +1,130 @@
+#pragma once
+
+#include <algorithm>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "profiler.h"
+#include "rewind.h"
+#include "udp.h"
+#include "world.h"
+
+// Two-player lockstep over UDP, with input delay and rollback.
+//
+// Both peers run the same two-player simulation. The local player's input
+// is scheduled `inputDelay` ticks ahead and sent to the peer every tick,
+// along with every earlier input the peer hasn't acknowledged, so a lost
+// datagram is covered by the next one. A tick whose remote input hasn't
+// arrived yet is simulated with a prediction (the last remote input
+// received), so local input never waits on the network. When the real
+// input arrives and differs, the world is restored from a RewindBuffer to
+// that tick and the ticks since are simulated again. Debris isn't part of
+// the saved state, so a rollback clears what was on screen.
+//
+// The simulation never runs more than NET_MAX_PREDICTION ticks past the
+// last remote input; past that, advance() stalls. Every NET_SYNC_INTERVAL
+// ticks each peer hashes a state both inputs are known for and sends the
+// hash along, so the peers can tell if they ever disagree.
+//
+// One datagram goes out per tick simulated, or per NET_RESEND_MS while
+// nothing is, so a lost one is followed up even when both sides wait.
+//
+// Datagram layout (little-endian):
+//   "SWNP"  u8 sender's player  u32 sender's tick  u32 inputs received
+//   i8 tick advantage  u32 sync tick  u64 sync hash
+//   u32 first input tick  u8 input count  u8 inputs[count]
+
+const std::uint32_t NET_MAX_PREDICTION = 8;
+const std::uint32_t NET_SYNC_INTERVAL = 60;
+const int NET_RESEND_MS = 16;
+
+struct NetStats {
+    long long ticks = 0;            // ticks advanced, resimulation not included
+    long long datagramsReceived = 0;
+    long long mispredicted = 0;     // remote inputs that differed from the guess
+    long long rollbacks = 0;
+    long long resimulatedTicks = 0;
+    RunningStats resimMicros;       // per rollback, restore included
+    long long stalls = 0;           // advance() refused: too far ahead of the peer
+    long long waits = 0;            // advance() refused: letting a slower peer catch up
+    long long syncChecks = 0, desyncs = 0;
+};
+
+// One tick of a networked game, the same on both peers: steps the world,
+// or starts the next game, on the next seed, if the last tick ended this one
+TickEvents netStep(World& world, std::uint8_t input);
+
+class NetSession {
+public:
+    // `player` is 0 or 1; both peers must use the same input delay
+    NetSession(int player, std::uint32_t inputDelay);
+
+    bool open(int localPort, const char* peer, const LinkShim& shim, std::string& error);
+
+    // Makes the world a fresh two-player game at tick 0
+    void start(World& world);
+
+    // Reads the peer's datagrams, rolls back if a prediction was wrong and
+    // sends this player's inputs when due; call every loop, ticking or not
+    void poll(World& world);
+
+    // Simulates the next tick with `input` (INPUT_LEFT, INPUT_RIGHT,
+    // INPUT_FIRE) as this player's. Returns false, leaving the world
+    // alone, when the session has to wait for the peer.
+    bool advance(World& world, std::uint8_t input, TickEvents* events = nullptr);
+
+    std::uint32_t tick() const { return now; }
+    // Ticks simulated with both players' real inputs
+    std::uint32_t confirmedTick() const { return std::min(now, remoteCount); }
+    // True once both peers hold each other's inputs for every tick before `end`
+    bool settled(std::uint32_t end) const { return now >= end && remoteCount >= end && peerAck >= end; }
+
+    const NetStats& stats() const { return counters; }
+    const UdpPeer& link() const { return peer; }
+
+private:
+    static const std::uint32_t RING = 256;
+
+    std::uint8_t remoteInput(std::uint32_t t) const;
+    std::uint8_t combined(std::uint32_t t, std::uint8_t remote) const;
+    void simulate(World& world, std::uint32_t t, TickEvents* events);
+    void receive(World& world);
+    void rollback(World& world, std::uint32_t from);
+    void checkSync();
+    void send();
+
+    int player;
+    std::uint32_t inputDelay;
+    UdpPeer peer;
+    RewindBuffer history;
+
+    // Inputs by tick, RING ticks deep: this player's, the peer's, and the
+    // peer input each simulated tick actually used
+    std::uint8_t localInputs[RING] = {};
+    std::uint8_t remoteInputs[RING] = {};
+    std::uint8_t usedInputs[RING] = {};
+
+    std::uint32_t now = 0;            // ticks simulated
+    std::uint32_t localCount = 0;     // this player's inputs scheduled
+    std::uint32_t remoteCount = 0;    // the peer's inputs received, in order
+    std::uint32_t peerAck = 0;        // this player's inputs the peer holds
+    std::uint32_t peerTick = 0;
+    int peerAdvantage = 0;
+    std::uint32_t waitTicks = 0, nextTimeSync = 0;
+    std::uint32_t sentTick = 0;
+    std::chrono::steady_clock::time_point sentAt;
+
+    // Sync hashes of recent checkpoints, by tick / NET_SYNC_INTERVAL
+    static const std::uint32_t SYNC_SLOTS = 8;
+    std::uint32_t syncTicks[SYNC_SLOTS] = {};
+    std::uint64_t syncHashes[SYNC_SLOTS] = {};
+    std::uint32_t peerSyncTick = 0, lastChecked = 0;
+    std::uint64_t peerSyncHash = 0;
+
+    NetStats counters;
+};
+
+// Prints the session's traffic, rollback and sync counters
+void printNetStats(const NetSession& session);
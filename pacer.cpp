@@ -0,0 +1,146 @@
+#include "pacer.h"
+
+#include <algorithm>
+#include <cmath>
+#include <thread>
+
+// Bounds for the spin margin, in ms; the upper one is also capped at a period
+static const double MIN_SPIN_MS = 0.25;
+static const double MAX_SPIN_MS = 4.0;
+
+static double milliseconds(std::chrono::steady_clock::duration d) {
+    return std::chrono::duration<double, std::milli>(d).count();
+}
+
+// Mean, standard deviation and p99 of a window of samples
+static void windowStats(const float* samples, int count, double& mean, double& stddev, double& p99) {
+    mean = stddev = p99 = 0.0;
+    if (count == 0) {
+        return;
+    }
+    float sorted[PACING_WINDOW];
+    std::copy(samples, samples + count, sorted);
+    std::sort(sorted, sorted + count);
+    double sum = 0.0, sumSquares = 0.0;
+    for (int i = 0; i < count; ++i) {
+        sum += sorted[i];
+        sumSquares += (double)sorted[i] * sorted[i];
+    }
+    mean = sum / count;
+    stddev = std::sqrt(std::max(0.0, sumSquares / count - mean * mean));
+    p99 = sorted[std::min(count - 1, (count * 99) / 100)];
+}
+
+FramePacer::FramePacer(double hz) {
+    setRate(hz);
+}
+
+FramePacer::~FramePacer() {
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+}
+
+void FramePacer::setRate(double hz) {
+    rateHz = hz > 0.0 ? hz : 0.0;
+    period = rateHz > 0.0 ? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / rateHz))
+                          : Clock::duration::zero();
+    scheduled = false;
+}
+
+void FramePacer::wait() {
+    waitMs = 0.0;
+    if (rateHz <= 0.0) {
+        return;
+    }
+    Clock::time_point start = Clock::now();
+    if (!scheduled) {
+        next = start + period;
+        scheduled = true;
+        return;
+    }
+    if (start >= next) {
+        if (start - next >= period) {
+            ++missed;
+            next = start;
+        }
+        next += period;
+        return;
+    }
+
+    // Sleep through most of the wait, then spin for the last stretch
+    Clock::time_point spinFrom = next - std::chrono::duration_cast<Clock::duration>(
+                                           std::chrono::duration<double, std::milli>(spinMs));
+    if (start < spinFrom) {
+        std::this_thread::sleep_until(spinFrom);
+        // Keep the margin a little above how late sleeps wake, and let it
+        // shrink back slowly after a bad one
+        double lateMs = milliseconds(Clock::now() - spinFrom) * 1.5;
+        double limit = std::min(MAX_SPIN_MS, milliseconds(period));
+        spinMs = lateMs > spinMs ? std::min(lateMs, limit) : std::max(MIN_SPIN_MS, spinMs * 0.99);
+    }
+    while (Clock::now() < next) {
+    }
+    waitMs = milliseconds(Clock::now() - start);
+    next += period;
+}
+
+void FramePacer::presented(std::int64_t presentMicros, std::int64_t inputMicros) {
+    double frameTime = -1.0, latencyTime = -1.0;
+    if (lastPresent >= 0) {
+        frameTime = (presentMicros - lastPresent) / 1000.0;
+        frameMs.add(frameTime);
+        recentFrames[framesHead] = (float)frameTime;
+        framesHead = (framesHead + 1) % PACING_WINDOW;
+        framesCount = std::min(framesCount + 1, PACING_WINDOW);
+    }
+    lastPresent = presentMicros;
+    if (inputMicros >= 0) {
+        latencyTime = (presentMicros - inputMicros) / 1000.0;
+        latencyMs.add(latencyTime);
+        recentLatency[latencyHead] = (float)latencyTime;
+        latencyHead = (latencyHead + 1) % PACING_WINDOW;
+        latencyCount = std::min(latencyCount + 1, PACING_WINDOW);
+    }
+
+    // Blank cells for a frame with nothing to measure
+    if (csv != nullptr) {
+        std::fprintf(csv, "%lld,", frame);
+        if (frameTime >= 0.0) {
+            std::fprintf(csv, "%.3f", frameTime);
+        }
+        std::fprintf(csv, ",%.3f,", waitMs);
+        if (latencyTime >= 0.0) {
+            std::fprintf(csv, "%.3f", latencyTime);
+        }
+        std::fputc('\n', csv);
+    }
+    ++frame;
+}
+
+bool FramePacer::openCsv(const char* path) {
+    csv = std::fopen(path, "w");
+    if (csv == nullptr) {
+        return false;
+    }
+    std::fprintf(csv, "frame,frame_ms,wait_ms,latency_ms\n");
+    return true;
+}
+
+std::string FramePacer::summary() const {
+    double frameMean, frameStddev, frameP99, latencyMean, latencyStddev, latencyP99;
+    windowStats(recentFrames, framesCount, frameMean, frameStddev, frameP99);
+    windowStats(recentLatency, latencyCount, latencyMean, latencyStddev, latencyP99);
+    char text[160];
+    if (rateHz > 0.0) {
+        std::snprintf(text, sizeof(text),
+                      "pacing %.0f Hz: frame %.2f ms +-%.2f (p99 %.2f), latency %.1f ms (p99 %.1f), %lld missed\n",
+                      rateHz, frameMean, frameStddev, frameP99, latencyMean, latencyP99, missed);
+    }
+    else {
+        std::snprintf(text, sizeof(text),
+                      "uncapped: frame %.2f ms +-%.2f (p99 %.2f), latency %.1f ms (p99 %.1f)\n",
+                      frameMean, frameStddev, frameP99, latencyMean, latencyP99);
+    }
+    return text;
+}
@@ -0,0 +1,73 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+#include "profiler.h"
+
+// Frame pacing. wait() holds the loop until the next frame is due: it
+// sleeps while more than a spin margin is left, then spins on the steady
+// clock for the rest, so frames start within microseconds of their slot
+// rather than whenever a coarse sleep returns. The margin follows how late
+// sleeps actually wake up on this machine. A rate of 0 runs uncapped.
+//
+// presented() is the instrumentation side: called after each display(),
+// it records the frame-to-frame time and an estimate of input latency
+// (from reading the input of the newest tick on screen to display()
+// returning; the compositor and scan-out come on top of that).
+
+const int PACING_WINDOW = 240;
+
+class FramePacer {
+public:
+    explicit FramePacer(double hz = 60.0);
+    ~FramePacer();
+    FramePacer(const FramePacer&) = delete;
+    FramePacer& operator=(const FramePacer&) = delete;
+
+    // Frames per second; 0 or less is uncapped. Restarts the schedule.
+    void setRate(double hz);
+    double rate() const { return rateHz; }
+
+    // Blocks until the next frame is due. A frame that starts a whole
+    // period late counts as missed and the schedule restarts from it,
+    // rather than rushing the frames after it.
+    void wait();
+
+    // Call right after display(). Both times are microseconds on the
+    // caller's clock; inputMicros is -1 when no new tick is on screen.
+    void presented(std::int64_t presentMicros, std::int64_t inputMicros);
+
+    // Starts writing one row per presented frame to `path`
+    bool openCsv(const char* path);
+
+    // One line for the overlay: recent frame times and latency
+    std::string summary() const;
+
+    const RunningStats& frameTimes() const { return frameMs; } // ms, present to present
+    const RunningStats& latency() const { return latencyMs; }  // ms, input read to present
+    long long missedFrames() const { return missed; }
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    double rateHz = 0;
+    Clock::duration period{};
+    Clock::time_point next{};
+    bool scheduled = false;
+    double spinMs = 2.0;
+    double waitMs = 0;
+    long long missed = 0;
+
+    RunningStats frameMs, latencyMs;
+    std::int64_t lastPresent = -1;
+    // The last PACING_WINDOW samples of each, for the overlay
+    float recentFrames[PACING_WINDOW];
+    float recentLatency[PACING_WINDOW];
+    int framesHead = 0, framesCount = 0;
+    int latencyHead = 0, latencyCount = 0;
+    long long frame = 0;
+    std::FILE* csv = nullptr;
+};
@@ -0,0 +1,30 @@
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#include "bundle.h"
+
+// Builds the asset bundle the game loads at startup.
+// Usage: pack OUTPUT FILE...
+//   pack assets.pak player.png enemy.png background.png alien.ttf shoot.mp3 hit.mp3
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        std::fprintf(stderr, "usage: %s OUTPUT FILE...\n", argv[0]);
+        return 2;
+    }
+
+    std::vector<std::string> files(argv + 2, argv + argc);
+    if (!writeBundle(argv[1], files)) {
+        std::fprintf(stderr, "could not write %s\n", argv[1]);
+        return 1;
+    }
+
+    AssetBundle bundle;
+    if (!bundle.open(argv[1])) {
+        std::fprintf(stderr, "%s does not read back\n", argv[1]);
+        return 1;
+    }
+    std::printf("packed %zu assets into %s\n", files.size(), argv[1]);
+    return 0;
+}
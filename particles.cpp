@@ -0,0 +1,237 @@
+#include "particles.h"
+
+#include <algorithm>
+
+#include "formation.h"
+
+#if (defined(__x86_64__) || defined(__i386__)) && defined(__GNUC__)
+#define PARTICLES_X86 1
+#include <immintrin.h>
+#endif
+
+void ParticlePool::reserve(std::size_t n, float w, float h) {
+    n = std::min(n, (std::size_t)MAX_PARTICLES);
+    std::size_t rounded = n > 0 ? 1 : 0;
+    while (rounded < n) {
+        rounded <<= 1;
+    }
+    width = w;
+    height = h;
+    if (rounded == capacity) {
+        clear();
+        return;
+    }
+    x.assign(rounded, 0.0f);
+    y.assign(rounded, 0.0f);
+    vx.assign(rounded, 0.0f);
+    vy.assign(rounded, 0.0f);
+    life.assign(rounded, 0);
+    shade.assign(rounded, 0);
+    capacity = (std::uint32_t)rounded;
+    clear();
+}
+
+void ParticlePool::clear() {
+    std::fill(life.begin(), life.end(), 0);
+    head = 0;
+    count = 0;
+}
+
+void ParticlePool::spawn(float px, float py, float pvx, float pvy, std::uint16_t ticks, std::uint8_t colorIndex) {
+    if (capacity == 0) {
+        return;
+    }
+    std::uint32_t i = head;
+    x[i] = px;
+    y[i] = py;
+    vx[i] = pvx;
+    vy[i] = pvy;
+    life[i] = ticks;
+    shade[i] = colorIndex;
+    head = (head + 1) & (capacity - 1);
+    if (count < capacity) {
+        ++count;
+    }
+}
+
+int particleSpans(const ParticlePool& pool, ParticleSpan spans[2]) {
+    if (pool.count == 0) {
+        return 0;
+    }
+    std::uint32_t first = pool.tail();
+    std::uint32_t toEnd = pool.capacity - first;
+    spans[0].first = first;
+    if (pool.count <= toEnd) {
+        spans[0].count = pool.count;
+        return 1;
+    }
+    spans[0].count = toEnd;
+    spans[1].first = 0;
+    spans[1].count = pool.count - toEnd;
+    return 2;
+}
+
+// Integration is a plain add of the per-tick velocity, so every kernel
+// produces the same bits and replays don't depend on the CPU
+
+static void integrateScalar(float* x, float* y, const float* vx, const float* vy, std::uint16_t* life,
+                            std::size_t n) {
+    for (std::size_t i = 0; i < n; ++i) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+        life[i] = life[i] > 0 ? life[i] - 1 : 0;
+    }
+}
+
+// Any live particle whose top-left corner is strictly inside the bounds
+static bool overlapScalar(const float* x, const float* y, const std::uint16_t* life, std::size_t n, float left,
+                          float right, float top, float bottom) {
+    for (std::size_t i = 0; i < n; ++i) {
+        if (life[i] != 0 && x[i] > left && x[i] < right && y[i] > top && y[i] < bottom) {
+            return true;
+        }
+    }
+    return false;
+}
+
+#ifdef PARTICLES_X86
+
+__attribute__((target("sse2")))
+static void integrateSSE(float* x, float* y, const float* vx, const float* vy, std::uint16_t* life,
+                         std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        _mm_storeu_ps(x + i, _mm_add_ps(_mm_loadu_ps(x + i), _mm_loadu_ps(vx + i)));
+        _mm_storeu_ps(y + i, _mm_add_ps(_mm_loadu_ps(y + i), _mm_loadu_ps(vy + i)));
+    }
+    for (; i < n; ++i) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+
+    // Saturating subtract keeps dead particles at zero
+    std::size_t j = 0;
+    __m128i one = _mm_set1_epi16(1);
+    for (; j + 8 <= n; j += 8) {
+        __m128i* p = (__m128i*)(life + j);
+        _mm_storeu_si128(p, _mm_subs_epu16(_mm_loadu_si128(p), one));
+    }
+    for (; j < n; ++j) {
+        life[j] = life[j] > 0 ? life[j] - 1 : 0;
+    }
+}
+
+__attribute__((target("avx2")))
+static void integrateAVX2(float* x, float* y, const float* vx, const float* vy, std::uint16_t* life,
+                          std::size_t n) {
+    std::size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        _mm256_storeu_ps(x + i, _mm256_add_ps(_mm256_loadu_ps(x + i), _mm256_loadu_ps(vx + i)));
+        _mm256_storeu_ps(y + i, _mm256_add_ps(_mm256_loadu_ps(y + i), _mm256_loadu_ps(vy + i)));
+    }
+    for (; i < n; ++i) {
+        x[i] += vx[i];
+        y[i] += vy[i];
+    }
+
+    std::size_t j = 0;
+    __m256i one = _mm256_set1_epi16(1);
+    for (; j + 16 <= n; j += 16) {
+        __m256i* p = (__m256i*)(life + j);
+        _mm256_storeu_si256(p, _mm256_subs_epu16(_mm256_loadu_si256(p), one));
+    }
+    for (; j < n; ++j) {
+        life[j] = life[j] > 0 ? life[j] - 1 : 0;
+    }
+}
+
+__attribute__((target("sse2")))
+static bool overlapSSE(const float* x, const float* y, const std::uint16_t* life, std::size_t n, float left,
+                       float right, float top, float bottom) {
+    __m128 l = _mm_set1_ps(left), r = _mm_set1_ps(right);
+    __m128 t = _mm_set1_ps(top), b = _mm_set1_ps(bottom);
+    __m128i zero = _mm_setzero_si128();
+    __m128 hit = _mm_setzero_ps();
+    std::size_t i = 0;
+    for (; i + 4 <= n; i += 4) {
+        __m128 px = _mm_loadu_ps(x + i), py = _mm_loadu_ps(y + i);
+        __m128 inside = _mm_and_ps(_mm_and_ps(_mm_cmpgt_ps(px, l), _mm_cmplt_ps(px, r)),
+                                   _mm_and_ps(_mm_cmpgt_ps(py, t), _mm_cmplt_ps(py, b)));
+        // Widen the four lives' dead flags to 32-bit lanes
+        __m128i dead = _mm_cmpeq_epi16(_mm_loadl_epi64((const __m128i*)(life + i)), zero);
+        dead = _mm_unpacklo_epi16(dead, dead);
+        hit = _mm_or_ps(hit, _mm_andnot_ps(_mm_castsi128_ps(dead), inside));
+    }
+    return _mm_movemask_ps(hit) != 0 || overlapScalar(x + i, y + i, life + i, n - i, left, right, top, bottom);
+}
+
+#endif
+
+void integrateParticles(ParticlePool& pool) {
+    // Same CPU choice as the formation kernels
+    FormationKernel kernel = activeFormationKernel();
+    ParticleSpan spans[2];
+    int n = particleSpans(pool, spans);
+    for (int s = 0; s < n; ++s) {
+        std::uint32_t f = spans[s].first;
+        float* x = pool.x.data() + f;
+        float* y = pool.y.data() + f;
+        const float* vx = pool.vx.data() + f;
+        const float* vy = pool.vy.data() + f;
+        std::uint16_t* life = pool.life.data() + f;
+#ifdef PARTICLES_X86
+        if (kernel == FormationKernel::AVX2) {
+            integrateAVX2(x, y, vx, vy, life, spans[s].count);
+            continue;
+        }
+        if (kernel == FormationKernel::SSE) {
+            integrateSSE(x, y, vx, vy, life, spans[s].count);
+            continue;
+        }
+#endif
+        (void)kernel;
+        integrateScalar(x, y, vx, vy, life, spans[s].count);
+    }
+
+    // Reclaim the dead at the old end of the ring
+    while (pool.count > 0 && pool.life[pool.tail()] == 0) {
+        --pool.count;
+    }
+}
+
+bool particlesOverlapRect(const ParticlePool& pool, float rx, float ry, float rw, float rh) {
+    // Shift the test so each particle is compared by its top-left corner
+    float left = rx - pool.width, right = rx + rw;
+    float top = ry - pool.height, bottom = ry + rh;
+    ParticleSpan spans[2];
+    int n = particleSpans(pool, spans);
+    for (int s = 0; s < n; ++s) {
+        const float* x = pool.x.data() + spans[s].first;
+        const float* y = pool.y.data() + spans[s].first;
+        const std::uint16_t* life = pool.life.data() + spans[s].first;
+#ifdef PARTICLES_X86
+        if (activeFormationKernel() != FormationKernel::Scalar) {
+            if (overlapSSE(x, y, life, spans[s].count, left, right, top, bottom)) {
+                return true;
+            }
+            continue;
+        }
+#endif
+        if (overlapScalar(x, y, life, spans[s].count, left, right, top, bottom)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+std::size_t liveParticles(const ParticlePool& pool) {
+    std::size_t live = 0;
+    ParticleSpan spans[2];
+    int n = particleSpans(pool, spans);
+    for (int s = 0; s < n; ++s) {
+        for (std::uint32_t i = 0; i < spans[s].count; ++i) {
+            live += pool.life[spans[s].first + i] != 0;
+        }
+    }
+    return live;
+}
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+// Short-lived things that fly in straight lines: enemy shots and
+// explosion debris. A pool is a fixed-capacity ring stored as a structure
+// of arrays. Particles are allocated in time order at `head`, so the live
+// ones always sit in the `count` slots before it; when the ring is full
+// the oldest particle is overwritten. Dead slots at the old end are
+// reclaimed as the span advances, and dead slots inside it are skipped.
+// Nothing touches the heap once the pool is reserved.
+
+// The largest ring reserve() will size; bigger requests are clamped to it
+const std::uint32_t MAX_PARTICLES = 1u << 24;
+
+struct ParticlePool {
+    std::vector<float> x, y;
+    std::vector<float> vx, vy;            // pixels per tick
+    std::vector<std::uint16_t> life;      // ticks left; 0 is dead
+    std::vector<std::uint8_t> shade;      // color index for the renderer
+    std::uint32_t capacity = 0, head = 0, count = 0;
+    float width = 0, height = 0;          // every particle's box
+
+    std::uint32_t tail() const { return (head - count) & (capacity - 1); }
+    bool empty() const { return count == 0; }
+
+    // Sizes the ring for n particles (rounded up to a power of two, at
+    // most MAX_PARTICLES) of size w x h and empties it
+    void reserve(std::size_t n, float w, float h);
+    void clear();
+
+    void spawn(float px, float py, float pvx, float pvy, std::uint16_t ticks, std::uint8_t colorIndex);
+};
+
+// A run of consecutive slots; the live span wraps into at most two
+struct ParticleSpan {
+    std::uint32_t first = 0, count = 0;
+};
+
+// Fills `spans` with the live span, oldest first; returns how many are used
+int particleSpans(const ParticlePool& pool, ParticleSpan spans[2]);
+
+// Moves every particle in the live span one tick along its velocity,
+// ages it, and reclaims dead slots at the old end
+void integrateParticles(ParticlePool& pool);
+
+// True if a live particle's box overlaps the rectangle
+bool particlesOverlapRect(const ParticlePool& pool, float rx, float ry, float rw, float rh);
+
+// Live particles, for stats
+std::size_t liveParticles(const ParticlePool& pool);
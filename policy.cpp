@@ -0,0 +1,127 @@
+#include "policy.h"
+
+#include <cstring>
+
+static std::uint32_t nextRandom(std::uint32_t& state) {
+    state ^= state << 13;
+    state ^= state >> 17;
+    state ^= state << 5;
+    return state;
+}
+
+void seedPolicy(PolicyState& state, std::uint32_t seed) {
+    state.rng = seed != 0 ? seed : 1;
+    state.held = 0;
+}
+
+std::uint8_t idlePolicy(const World&, PolicyState&) {
+    return 0;
+}
+
+std::uint8_t randomPolicy(const World& world, PolicyState& state) {
+    if (world.tick % 8 == 0) {
+        state.held = (std::uint8_t)(nextRandom(state.rng) & (INPUT_LEFT | INPUT_RIGHT | INPUT_FIRE));
+    }
+    return state.held;
+}
+
+// How far the player moves in one tick under the world's tuning
+static float playerStep(const World& world) {
+    return withTuning(world.tuning, [](auto config) { return decltype(config)::PLAYER_SPEED * TICK_DT; });
+}
+
+// How far ahead the bot looks for enemy shots
+const float DODGE_TICKS = 30.0f;
+
+// Steps away from the soonest shot that will cross the player's column
+// within DODGE_TICKS; 0 when nothing is coming. The column is widened by
+// two steps each side, so aiming can't walk the player into a shot.
+static std::uint8_t dodge(const World& world) {
+    const ParticlePool& shots = world.shots;
+    float margin = 2 * playerStep(world);
+    float left = world.playerX - margin, right = world.playerX + world.playerWidth + margin;
+    float soonest = DODGE_TICKS, threatLeft = 0.0f, threatRight = 0.0f;
+    bool threatened = false;
+
+    ParticleSpan spans[2];
+    int n = particleSpans(shots, spans);
+    for (int s = 0; s < n; ++s) {
+        for (std::uint32_t k = 0; k < spans[s].count; ++k) {
+            std::uint32_t i = spans[s].first + k;
+            if (shots.life[i] == 0 || shots.vy[i] <= 0 || shots.x[i] + shots.width <= left || shots.x[i] >= right ||
+                shots.y[i] >= world.playerY + world.playerHeight) {
+                continue;
+            }
+            float ticks = (world.playerY - shots.y[i] - shots.height) / shots.vy[i];
+            if (ticks < soonest) {
+                soonest = ticks;
+                threatLeft = shots.x[i];
+                threatRight = shots.x[i] + shots.width;
+                threatened = true;
+            }
+        }
+    }
+    if (!threatened) {
+        return 0;
+    }
+
+    // The shorter way out, unless the wall leaves no room for it
+    float toLeft = world.playerX + world.playerWidth - threatLeft;
+    float toRight = threatRight - world.playerX;
+    bool leftOpen = toLeft <= world.playerX;
+    bool rightOpen = toRight <= WINDOW_WIDTH - world.playerWidth - world.playerX;
+    bool goLeft = leftOpen && (!rightOpen || toLeft <= toRight);
+    return goLeft ? INPUT_LEFT : INPUT_RIGHT;
+}
+
+std::uint8_t botPolicy(const World& world, PolicyState&) {
+    const EntityArrays& enemies = world.enemies;
+    if (enemies.empty()) {
+        return 0;
+    }
+
+    // The lowest enemy is the most urgent; break ties by distance
+    float center = world.playerX + world.playerWidth / 2;
+    std::size_t target = 0;
+    for (std::size_t i = 1; i < enemies.size(); ++i) {
+        float dy = enemies.y[i] - enemies.y[target];
+        float distance = enemies.x[i] + enemies.w[i] / 2 - center;
+        float targetDistance = enemies.x[target] + enemies.w[target] / 2 - center;
+        if (dy > 0 || (dy == 0 && distance * distance < targetDistance * targetDistance)) {
+            target = i;
+        }
+    }
+
+    float offset = enemies.x[target] + enemies.w[target] / 2 - center;
+    float step = playerStep(world);
+    std::uint8_t input = 0;
+    if (offset < -step) {
+        input |= INPUT_LEFT;
+    }
+    else if (offset > step) {
+        input |= INPUT_RIGHT;
+    }
+    if (offset * offset < enemies.w[target] * enemies.w[target] / 4) {
+        input |= INPUT_FIRE;
+    }
+
+    // Staying alive comes before lining up the next shot
+    std::uint8_t evade = dodge(world);
+    if (evade != 0) {
+        input = (input & INPUT_FIRE) | evade;
+    }
+    return input;
+}
+
+InputPolicy findPolicy(const char* name) {
+    if (std::strcmp(name, "idle") == 0) {
+        return idlePolicy;
+    }
+    if (std::strcmp(name, "random") == 0) {
+        return randomPolicy;
+    }
+    if (std::strcmp(name, "bot") == 0) {
+        return botPolicy;
+    }
+    return nullptr;
+}
@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstdint>
+
+#include "world.h"
+
+// Input policies: scripted players that pick each tick's input from the
+// world. They keep whatever they need in PolicyState, so one function
+// can drive any number of independent games.
+
+struct PolicyState {
+    std::uint32_t rng = 1;
+    std::uint8_t held = 0;
+};
+
+typedef std::uint8_t (*InputPolicy)(const World& world, PolicyState& state);
+
+// Never presses anything
+std::uint8_t idlePolicy(const World& world, PolicyState& state);
+// Random buttons, each combination held for 8 ticks like a player would
+std::uint8_t randomPolicy(const World& world, PolicyState& state);
+// Steers under the lowest enemy and fires when lined up
+std::uint8_t botPolicy(const World& world, PolicyState& state);
+
+// Looks a policy up by name ("idle", "random", "bot"); nullptr if unknown
+InputPolicy findPolicy(const char* name);
+
+// Seeds the policy state; seed 0 is remapped since xorshift can't use it
+void seedPolicy(PolicyState& state, std::uint32_t seed);
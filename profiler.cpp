@@ -0,0 +1,104 @@
+#include "profiler.h"
+
+#include <algorithm>
+#include <cmath>
+
+static const char* const PHASE_NAMES[PHASE_COUNT] = {
+    "input", "bullets", "enemies", "particles", "collisions", "outcome", "render"
+};
+
+const char* phaseName(int phase) {
+    return PHASE_NAMES[phase];
+}
+
+FrameProfiler::FrameProfiler() {
+    std::fill(current, current + PHASE_COUNT, 0);
+}
+
+FrameProfiler::~FrameProfiler() {
+    if (csv != nullptr) {
+        std::fclose(csv);
+    }
+}
+
+void FrameProfiler::endFrame() {
+    if (!enabled) {
+        return;
+    }
+
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        samples[p][head] = current[p] / 1000.0f;
+    }
+    head = (head + 1) % PROFILE_WINDOW;
+    count = std::min(count + 1, PROFILE_WINDOW);
+
+    if (csv != nullptr) {
+        std::fprintf(csv, "%lld", frame);
+        for (int p = 0; p < PHASE_COUNT; ++p) {
+            std::fprintf(csv, ",%.3f", current[p] / 1000.0);
+        }
+        std::fputc('\n', csv);
+    }
+
+    ++frame;
+    std::fill(current, current + PHASE_COUNT, 0);
+}
+
+PhaseStats FrameProfiler::stats(int phase) const {
+    PhaseStats result;
+    if (count == 0) {
+        return result;
+    }
+
+    float sorted[PROFILE_WINDOW];
+    std::copy(samples[phase], samples[phase] + count, sorted);
+    std::sort(sorted, sorted + count);
+    result.p50 = sorted[count / 2];
+    result.p99 = sorted[std::min(count - 1, (count * 99) / 100)];
+    result.max = sorted[count - 1];
+    return result;
+}
+
+std::string FrameProfiler::summary() const {
+    std::string text = "phase         p50     p99     max (us)\n";
+    char line[96];
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        PhaseStats s = stats(p);
+        std::snprintf(line, sizeof(line), "%-11s %7.1f %7.1f %7.1f\n", phaseName(p), s.p50, s.p99, s.max);
+        text += line;
+    }
+    return text;
+}
+
+bool FrameProfiler::openCsv(const char* path) {
+    csv = std::fopen(path, "w");
+    if (csv == nullptr) {
+        return false;
+    }
+    std::fprintf(csv, "frame");
+    for (int p = 0; p < PHASE_COUNT; ++p) {
+        std::fprintf(csv, ",%s_us", phaseName(p));
+    }
+    std::fputc('\n', csv);
+    enabled = true;
+    return true;
+}
+
+void RunningStats::add(double value) {
+    ++count;
+    sum += value;
+    sumSquares += value * value;
+    max = std::max(max, value);
+}
+
+double RunningStats::mean() const {
+    return count > 0 ? sum / count : 0.0;
+}
+
+double RunningStats::stddev() const {
+    if (count < 2) {
+        return 0.0;
+    }
+    double m = mean();
+    return std::sqrt(std::max(0.0, sumSquares / count - m * m));
+}
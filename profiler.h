@@ -0,0 +1,91 @@
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <string>
+
+// Per-phase frame profiler. Scoped timers add their elapsed time to the
+// current frame; endFrame() pushes the frame's per-phase totals into a
+// rolling window used for p50/p99/max, and optionally appends a CSV row.
+// A disabled profiler costs one branch per timer.
+
+enum ProfilePhase {
+    PHASE_INPUT,
+    PHASE_BULLETS,
+    PHASE_ENEMIES,
+    PHASE_PARTICLES,
+    PHASE_COLLISIONS,
+    PHASE_OUTCOME,
+    PHASE_RENDER,
+    PHASE_COUNT
+};
+
+const int PROFILE_WINDOW = 240;
+
+struct PhaseStats {
+    float p50 = 0, p99 = 0, max = 0; // microseconds
+};
+
+class FrameProfiler {
+public:
+    FrameProfiler();
+    ~FrameProfiler();
+
+    bool enabled = false;
+
+    void add(int phase, std::int64_t nanoseconds) { current[phase] += nanoseconds; }
+    void endFrame();
+
+    PhaseStats stats(int phase) const;
+    // Multi-line summary of every phase, for the on-screen overlay
+    std::string summary() const;
+
+    // Starts writing one row per frame to `path`; enables the profiler
+    bool openCsv(const char* path);
+
+private:
+    std::int64_t current[PHASE_COUNT];
+    float samples[PHASE_COUNT][PROFILE_WINDOW];
+    int head = 0, count = 0;
+    long long frame = 0;
+    std::FILE* csv = nullptr;
+};
+
+const char* phaseName(int phase);
+
+// Mean, standard deviation and max of a stream of samples, without
+// keeping them; used for tick jitter and input latency
+struct RunningStats {
+    long long count = 0;
+    double sum = 0, sumSquares = 0, max = 0;
+
+    void add(double value);
+    double mean() const;
+    double stddev() const;
+};
+
+class ScopedTimer {
+public:
+    ScopedTimer(FrameProfiler* profiler, int phase)
+        : profiler(profiler != nullptr && profiler->enabled ? profiler : nullptr), phase(phase) {
+        if (this->profiler != nullptr) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+
+    ~ScopedTimer() {
+        if (profiler != nullptr) {
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            profiler->add(phase, std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count());
+        }
+    }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+private:
+    FrameProfiler* profiler;
+    int phase;
+    std::chrono::steady_clock::time_point start;
+};
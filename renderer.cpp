@@ -0,0 +1,131 @@
+#include "renderer.h"
+
+#include <algorithm>
+#include <cstdio>
+
+const int VERTICES_PER_QUAD = 6;
+
+// By ParticleShade
+static const sf::Color PARTICLE_COLORS[] = {
+    sf::Color(255, 220, 80), sf::Color(255, 140, 30), sf::Color(220, 60, 20), sf::Color(255, 255, 200)
+};
+
+// Writes one quad as two triangles starting at vertices[first]
+static void writeQuad(sf::VertexArray& vertices, std::size_t first, float x, float y, float w, float h,
+                      float texWidth, float texHeight, sf::Color color) {
+    sf::Vertex* v = &vertices[first];
+    v[0].position = { x, y };
+    v[1].position = { x + w, y };
+    v[2].position = { x + w, y + h };
+    v[3].position = { x, y };
+    v[4].position = { x + w, y + h };
+    v[5].position = { x, y + h };
+
+    v[0].texCoords = { 0, 0 };
+    v[1].texCoords = { texWidth, 0 };
+    v[2].texCoords = { texWidth, texHeight };
+    v[3].texCoords = { 0, 0 };
+    v[4].texCoords = { texWidth, texHeight };
+    v[5].texCoords = { 0, texHeight };
+
+    for (int k = 0; k < VERTICES_PER_QUAD; ++k) {
+        v[k].color = color;
+    }
+}
+
+// Grows the array to hold `quads` quads; never shrinks so storage is reused
+static void reserveQuads(sf::VertexArray& vertices, std::size_t quads) {
+    std::size_t needed = quads * VERTICES_PER_QUAD;
+    if (vertices.getVertexCount() < needed) {
+        vertices.resize(needed);
+    }
+}
+
+BatchRenderer::BatchRenderer(const sf::Texture& enemyTexture)
+    : enemyTexture(enemyTexture), enemyVertices(sf::Triangles), bulletVertices(sf::Triangles) {
+}
+
+int BatchRenderer::draw(sf::RenderTarget& target, const World& world) {
+    build(world);
+    return submit(target);
+}
+
+void BatchRenderer::build(const World& world) {
+    build(world.bullets, 0, world.enemies, 0, 0);
+}
+
+void BatchRenderer::build(const EntityArrays& bullets, float bulletDy, const EntityArrays& enemies, float enemyDx,
+                          float enemyDy) {
+    bulletCount = bullets.size();
+    particleCount = 0;
+    reserveQuads(bulletVertices, bulletCount);
+    for (std::size_t i = 0; i < bulletCount; ++i) {
+        writeQuad(bulletVertices, i * VERTICES_PER_QUAD, bullets.x[i], bullets.y[i] + bulletDy, bullets.w[i],
+                  bullets.h[i], 0, 0, sf::Color::Red);
+    }
+
+    sf::Vector2u size = enemyTexture.getSize();
+    enemyCount = enemies.size();
+    reserveQuads(enemyVertices, enemyCount);
+    for (std::size_t i = 0; i < enemyCount; ++i) {
+        writeQuad(enemyVertices, i * VERTICES_PER_QUAD, enemies.x[i] + enemyDx, enemies.y[i] + enemyDy, enemies.w[i],
+                  enemies.h[i], (float)size.x, (float)size.y, sf::Color::White);
+    }
+}
+
+std::size_t BatchRenderer::addParticles(const ParticlePool& particles, float back) {
+    std::size_t first = bulletCount + particleCount;
+    reserveQuads(bulletVertices, first + particles.count);
+
+    std::size_t quads = 0;
+    ParticleSpan spans[2];
+    int n = particleSpans(particles, spans);
+    for (int s = 0; s < n; ++s) {
+        for (std::uint32_t k = 0; k < spans[s].count; ++k) {
+            std::uint32_t i = spans[s].first + k;
+            if (particles.life[i] == 0) {
+                continue;
+            }
+            // Fade out over the last 16 ticks
+            sf::Color color = PARTICLE_COLORS[particles.shade[i] & 3];
+            color.a = (sf::Uint8)std::min(255, particles.life[i] * 16);
+            writeQuad(bulletVertices, (first + quads) * VERTICES_PER_QUAD, particles.x[i] - back * particles.vx[i],
+                      particles.y[i] - back * particles.vy[i], particles.width, particles.height, 0, 0, color);
+            ++quads;
+        }
+    }
+    particleCount += quads;
+    return quads;
+}
+
+int BatchRenderer::submit(sf::RenderTarget& target) const {
+    int drawCalls = 0;
+    if (bulletCount + particleCount > 0) {
+        target.draw(&bulletVertices[0], (bulletCount + particleCount) * VERTICES_PER_QUAD, sf::Triangles);
+        ++drawCalls;
+    }
+    if (enemyCount > 0) {
+        target.draw(&enemyVertices[0], enemyCount * VERTICES_PER_QUAD, sf::Triangles, sf::RenderStates(&enemyTexture));
+        ++drawCalls;
+    }
+    return drawCalls;
+}
+
+void recordRenderFrame(RenderStats& stats, int drawCalls, long long pixelsFilled, sf::Time cpuTime) {
+    stats.drawCalls = drawCalls;
+    stats.pixelsFilled = pixelsFilled;
+    stats.cpuMicroseconds = (float)cpuTime.asMicroseconds();
+    ++stats.frames;
+    stats.totalDrawCalls += drawCalls;
+    stats.totalPixelsFilled += pixelsFilled;
+    stats.totalCpuMicroseconds += stats.cpuMicroseconds;
+}
+
+void printRenderStats(const RenderStats& stats) {
+    if (stats.frames == 0) {
+        return;
+    }
+    std::printf("render: %lld frames, %.1f draw calls/frame, %.2f Mpx filled/frame, %.1f us CPU/frame\n",
+                stats.frames, (double)stats.totalDrawCalls / stats.frames,
+                stats.totalPixelsFilled / 1e6 / stats.frames, stats.totalCpuMicroseconds / stats.frames);
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "world.h"
+
+// Draws all enemies and all bullets as two batches: one vertex array of
+// textured quads sharing the enemy texture and one of untextured bullet
+// rectangles, which enemy shots and debris are appended to. The vertex
+// arrays only ever grow and are rewritten in place.
+
+struct RenderStats {
+    // Last frame
+    int drawCalls = 0;
+    long long pixelsFilled = 0;
+    float cpuMicroseconds = 0.0f;
+
+    // Running totals for the end-of-run summary
+    long long frames = 0;
+    long long totalDrawCalls = 0;
+    long long totalPixelsFilled = 0;
+    double totalCpuMicroseconds = 0.0;
+};
+
+class BatchRenderer {
+public:
+    explicit BatchRenderer(const sf::Texture& enemyTexture);
+
+    // Builds and submits the enemy and bullet batches; returns the draw
+    // calls issued
+    int draw(sf::RenderTarget& target, const World& world);
+
+    // The two halves of draw(): filling the vertex arrays needs no render
+    // target, so it can be benchmarked without a display
+    void build(const World& world);
+    // Builds from arrays copied out of a world, shifting every bullet by
+    // bulletDy and every enemy by (enemyDx, enemyDy) for interpolation
+    void build(const EntityArrays& bullets, float bulletDy, const EntityArrays& enemies, float enemyDx, float enemyDy);
+    // Appends a pool's live particles to the bullet batch after build(),
+    // each stepped back by `back` of its last move; returns the quads added
+    std::size_t addParticles(const ParticlePool& particles, float back);
+    int submit(sf::RenderTarget& target) const;
+
+private:
+    const sf::Texture& enemyTexture;
+    sf::VertexArray enemyVertices;
+    sf::VertexArray bulletVertices;
+    std::size_t enemyCount = 0, bulletCount = 0, particleCount = 0;
+};
+
+void recordRenderFrame(RenderStats& stats, int drawCalls, long long pixelsFilled, sf::Time cpuTime);
+void printRenderStats(const RenderStats& stats);
@@ -0,0 +1,311 @@
+#include "replay.h"
+
+#include <cstdio>
+#include <cstring>
+
+#include "waves.h"
+
+const char REPLAY_MAGIC[4] = { 'S', 'W', 'R', 'P' };
+const std::uint16_t REPLAY_VERSION = 8;
+// A day at 60 ticks/sec; longer logs are taken to be corrupt
+const std::uint32_t MAX_REPLAY_TICKS = 24 * 60 * 60 * 60;
+
+// FNV-1a over raw bytes
+static void hashBytes(std::uint64_t& hash, const void* data, std::size_t size) {
+    const unsigned char* p = (const unsigned char*)data;
+    for (std::size_t i = 0; i < size; ++i) {
+        hash ^= p[i];
+        hash *= 1099511628211ull;
+    }
+}
+
+template <typename T>
+static void hashValue(std::uint64_t& hash, const T& value) {
+    hashBytes(hash, &value, sizeof(value));
+}
+
+static void hashFloats(std::uint64_t& hash, const std::vector<float>& values) {
+    if (!values.empty()) {
+        hashBytes(hash, values.data(), values.size() * sizeof(float));
+    }
+}
+
+std::uint64_t hashWorld(const World& world) {
+    std::uint64_t hash = 14695981039346656037ull;
+    hashValue(hash, world.tuning);
+    hashValue(hash, world.players);
+    hashValue(hash, world.player2X);
+    hashValue(hash, world.shootTimer2);
+    hashValue(hash, world.playerX);
+    hashValue(hash, world.playerY);
+    hashValue(hash, world.score);
+    hashValue(hash, world.shootTimer);
+    hashValue(hash, world.enemyDirection);
+    hashValue(hash, world.enemySpeed);
+    hashValue(hash, world.tick);
+    hashValue(hash, world.wave);
+    hashValue(hash, world.waveTick);
+    hashValue(hash, world.nextSpawn);
+    hashValue(hash, world.waveKills);
+    hashValue(hash, world.rng);
+    hashValue(hash, world.seed);
+    hashValue(hash, world.playerHit);
+
+    const EntityArrays* arrays[2] = { &world.bullets, &world.enemies };
+    for (const EntityArrays* entities : arrays) {
+        std::uint64_t count = entities->size();
+        hashValue(hash, count);
+        hashFloats(hash, entities->x);
+        hashFloats(hash, entities->y);
+        hashFloats(hash, entities->w);
+        hashFloats(hash, entities->h);
+    }
+
+    // Shots slot for slot, like the saved state
+    const ParticlePool& shots = world.shots;
+    hashValue(hash, shots.head);
+    hashValue(hash, shots.count);
+    hashFloats(hash, shots.x);
+    hashFloats(hash, shots.y);
+    hashFloats(hash, shots.vx);
+    hashFloats(hash, shots.vy);
+    if (!shots.life.empty()) {
+        hashBytes(hash, shots.life.data(), shots.life.size() * sizeof(std::uint16_t));
+    }
+    return hash;
+}
+
+std::uint64_t hashWaves(const WaveSet& waves) {
+    std::uint64_t hash = 14695981039346656037ull;
+    for (const WaveInfo& wave : waves.waves) {
+        hashValue(hash, wave.spawnCount);
+        hashValue(hash, wave.startSpeed);
+        hashValue(hash, wave.endSpeed);
+    }
+    for (const WaveSpawn& spawn : waves.spawns) {
+        hashValue(hash, spawn.tick);
+        hashValue(hash, spawn.x);
+        hashValue(hash, spawn.y);
+    }
+    return hash;
+}
+
+void beginInputLog(InputLog& log, const World& world) {
+    log.tuning = world.tuning;
+    log.players = world.players;
+    log.seed = world.seed;
+    log.playerWidth = world.playerWidth;
+    log.playerHeight = world.playerHeight;
+    log.enemyWidth = world.enemyWidth;
+    log.enemyHeight = world.enemyHeight;
+    log.bulletCapacity = (std::uint32_t)world.bulletCapacity;
+    log.shotCapacity = (std::uint32_t)world.shotCapacity;
+    log.wavesHash = hashWaves(activeWaves(world));
+    log.enemyMask = world.enemyMask != nullptr ? *world.enemyMask : SpriteMask();
+    log.inputs.clear();
+    log.finalHash = 0;
+}
+
+void recordInput(InputLog& log, std::uint8_t input) {
+    log.inputs.push_back(input);
+}
+
+void finishInputLog(InputLog& log, const World& world) {
+    log.finalHash = hashWorld(world);
+}
+
+// Little-endian writers and readers so logs move between machines
+
+static void putBytes(std::vector<std::uint8_t>& out, std::uint64_t value, int bytes) {
+    for (int i = 0; i < bytes; ++i) {
+        out.push_back((std::uint8_t)(value >> (8 * i)));
+    }
+}
+
+static void putFloat(std::vector<std::uint8_t>& out, float value) {
+    std::uint32_t bits;
+    std::memcpy(&bits, &value, sizeof(bits));
+    putBytes(out, bits, 4);
+}
+
+static void putVarint(std::vector<std::uint8_t>& out, std::uint32_t value) {
+    while (value >= 0x80) {
+        out.push_back((std::uint8_t)(value | 0x80));
+        value >>= 7;
+    }
+    out.push_back((std::uint8_t)value);
+}
+
+struct Reader {
+    const std::vector<std::uint8_t>& data;
+    std::size_t pos = 0;
+    bool ok = true;
+
+    std::size_t remaining() const { return data.size() - pos; }
+
+    std::uint64_t bytes(int count) {
+        if (pos + count > data.size()) {
+            ok = false;
+            return 0;
+        }
+        std::uint64_t value = 0;
+        for (int i = 0; i < count; ++i) {
+            value |= (std::uint64_t)data[pos++] << (8 * i);
+        }
+        return value;
+    }
+
+    float real() {
+        std::uint32_t bits = (std::uint32_t)bytes(4);
+        float value;
+        std::memcpy(&value, &bits, sizeof(value));
+        return value;
+    }
+
+    std::uint32_t varint() {
+        std::uint32_t value = 0;
+        for (int shift = 0; shift < 35; shift += 7) {
+            std::uint8_t b = (std::uint8_t)bytes(1);
+            value |= (std::uint32_t)(b & 0x7f) << shift;
+            if (!(b & 0x80)) {
+                return value;
+            }
+        }
+        ok = false;
+        return 0;
+    }
+};
+
+bool saveInputLog(const char* path, const InputLog& log) {
+    std::vector<std::uint8_t> out(REPLAY_MAGIC, REPLAY_MAGIC + 4);
+    putBytes(out, REPLAY_VERSION, 2);
+    putBytes(out, (std::uint16_t)(1.0f / TICK_DT + 0.5f), 2);
+    putBytes(out, (std::uint8_t)log.tuning, 1);
+    putBytes(out, (std::uint8_t)log.players, 1);
+    putBytes(out, log.seed, 8);
+    putFloat(out, log.playerWidth);
+    putFloat(out, log.playerHeight);
+    putFloat(out, log.enemyWidth);
+    putFloat(out, log.enemyHeight);
+    putBytes(out, log.bulletCapacity, 4);
+    putBytes(out, log.shotCapacity, 4);
+    putBytes(out, log.wavesHash, 8);
+    putBytes(out, log.enemyMask.width, 2);
+    putBytes(out, log.enemyMask.height, 2);
+    for (std::uint64_t word : log.enemyMask.bits) {
+        putBytes(out, word, 8);
+    }
+    putBytes(out, log.inputs.size(), 4);
+    putBytes(out, log.finalHash, 8);
+
+    // Inputs are held for many ticks at a time, so store them as runs
+    for (std::size_t i = 0; i < log.inputs.size();) {
+        std::size_t run = 1;
+        while (i + run < log.inputs.size() && log.inputs[i + run] == log.inputs[i]) {
+            ++run;
+        }
+        out.push_back(log.inputs[i]);
+        putVarint(out, (std::uint32_t)run);
+        i += run;
+    }
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(out.data(), 1, out.size(), file) == out.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool loadInputLog(const char* path, InputLog& log) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<std::uint8_t> data;
+    std::uint8_t buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        data.insert(data.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+
+    if (data.size() < 4 || std::memcmp(data.data(), REPLAY_MAGIC, 4) != 0) {
+        return false;
+    }
+    Reader in{ data, 4 };
+    std::uint16_t version = (std::uint16_t)in.bytes(2);
+    std::uint16_t tickRate = (std::uint16_t)in.bytes(2);
+    if (version != REPLAY_VERSION || tickRate != (std::uint16_t)(1.0f / TICK_DT + 0.5f)) {
+        return false;
+    }
+    std::uint8_t tuning = (std::uint8_t)in.bytes(1);
+    int players = (int)in.bytes(1);
+    if (tuning >= TUNING_COUNT || players < 1 || players > 2) {
+        return false;
+    }
+    log.tuning = (TuningId)tuning;
+    log.players = players;
+    log.seed = in.bytes(8);
+    log.playerWidth = in.real();
+    log.playerHeight = in.real();
+    log.enemyWidth = in.real();
+    log.enemyHeight = in.real();
+    log.bulletCapacity = (std::uint32_t)in.bytes(4);
+    log.shotCapacity = (std::uint32_t)in.bytes(4);
+    log.wavesHash = in.bytes(8);
+    if (log.shotCapacity > MAX_PARTICLES) {
+        return false;
+    }
+    log.enemyMask = SpriteMask();
+    int maskWidth = (int)in.bytes(2), maskHeight = (int)in.bytes(2);
+    if (maskWidth > 0 && maskHeight > 0) {
+        // Each word is 8 bytes; a mask the file can't hold is corrupt
+        if ((std::size_t)(maskWidth + 63) / 64 * maskHeight * 8 > in.remaining()) {
+            return false;
+        }
+        log.enemyMask.width = maskWidth;
+        log.enemyMask.height = maskHeight;
+        log.enemyMask.wordsPerRow = (maskWidth + 63) / 64;
+        log.enemyMask.bits.resize((std::size_t)log.enemyMask.wordsPerRow * maskHeight);
+        for (std::uint64_t& word : log.enemyMask.bits) {
+            word = in.bytes(8);
+        }
+    }
+    std::uint32_t ticks = (std::uint32_t)in.bytes(4);
+    log.finalHash = in.bytes(8);
+    if (ticks > MAX_REPLAY_TICKS) {
+        return false;
+    }
+
+    // The count comes from the file, so the inputs grow as runs are decoded
+    // rather than being reserved up front
+    log.inputs.clear();
+    while (in.ok && log.inputs.size() < ticks) {
+        std::uint8_t input = (std::uint8_t)in.bytes(1);
+        std::uint32_t run = in.varint();
+        if (run == 0 || log.inputs.size() + run > ticks) {
+            return false;
+        }
+        log.inputs.insert(log.inputs.end(), run, input);
+    }
+    return in.ok;
+}
+
+bool replayInputLog(const InputLog& log, World& world) {
+    setTuning(world, log.tuning);
+    world.players = log.players;
+    world.playerWidth = log.playerWidth;
+    world.playerHeight = log.playerHeight;
+    world.enemyWidth = log.enemyWidth;
+    world.enemyHeight = log.enemyHeight;
+    world.bulletCapacity = log.bulletCapacity;
+    world.shotCapacity = log.shotCapacity;
+    world.enemyMask = log.enemyMask.empty() ? nullptr : &log.enemyMask;
+    resetWorld(world, log.seed);
+
+    for (std::size_t i = 0; i < log.inputs.size(); ++i) {
+        stepWorld(world, log.inputs[i]);
+    }
+    return hashWorld(world) == log.finalHash;
+}
@@ -0,0 +1,57 @@
+#pragma once
+
+#include <cstdint>
+#include <vector>
+
+#include "mask.h"
+#include "world.h"
+
+// Input recording and replay. A log holds the world setup and one input
+// bitmask per fixed tick, plus the hash of the final state; replaying it
+// from a fresh world must reproduce that hash exactly.
+//
+// File layout (little-endian):
+//   "SWRP"  u16 version  u16 ticks per second
+//   u8 tuning  u8 players  u64 seed  f32 player w, h  f32 enemy w, h
+//   u32 bullet capacity  u32 shot capacity
+//   u64 waves hash
+//   u16 enemy mask w, h (0 for none)  u64 mask words, row by row
+//   u32 tick count  u64 final state hash
+//   runs of (u8 input, varint length) until tick count is covered
+
+struct InputLog {
+    TuningId tuning = TuningId::Classic;
+    int players = 1;
+    std::uint64_t seed = WORLD_RNG_SEED;
+    float playerWidth = DEFAULT_PLAYER_WIDTH, playerHeight = DEFAULT_PLAYER_HEIGHT;
+    float enemyWidth = DEFAULT_ENEMY_WIDTH, enemyHeight = DEFAULT_ENEMY_HEIGHT;
+    std::uint32_t bulletCapacity = ClassicTuning::BULLET_CAPACITY;
+    std::uint32_t shotCapacity = ClassicTuning::SHOT_CAPACITY;
+    std::uint64_t wavesHash = 0; // of the wave tables the game was played with
+    SpriteMask enemyMask;        // empty if collisions were box-only
+    std::vector<std::uint8_t> inputs;
+    std::uint64_t finalHash = 0;
+};
+
+// Hash of everything that affects future ticks
+std::uint64_t hashWorld(const World& world);
+
+// Identifies a compiled wave set, so a replay can't silently run against
+// different waves
+std::uint64_t hashWaves(const WaveSet& waves);
+
+// Captures the setup of a freshly reset world
+void beginInputLog(InputLog& log, const World& world);
+void recordInput(InputLog& log, std::uint8_t input);
+void finishInputLog(InputLog& log, const World& world);
+
+bool saveInputLog(const char* path, const InputLog& log);
+bool loadInputLog(const char* path, InputLog& log);
+
+// Applies the log's setup (tuning, players and seed included) to `world`,
+// resets it and steps every input.
+// Returns true if the final state hash matches the recorded one. The
+// world's waves must be the ones the log was recorded with (wavesHash).
+// The world's enemy mask is pointed at the log's, so the log must outlive
+// the world's use of it.
+bool replayInputLog(const InputLog& log, World& world);
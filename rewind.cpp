@@ -0,0 +1,168 @@
+#include "rewind.h"
+
+#include <algorithm>
+
+#include "state.h"
+
+// Delta streams are sequences of tokens: one word holding a run of
+// unchanged words (low 16 bits) and a count of changed words (high 16
+// bits), followed by the changed words XORed with the previous image.
+
+static const std::size_t MAX_RUN = 0xffff;
+
+// Worst case is alternating changed and unchanged words
+static std::size_t maxEncodedWords(std::size_t words) {
+    return words + words / 2 + 2;
+}
+
+// Encodes image XOR base, or the image itself for a keyframe
+template <bool Keyframe>
+static std::size_t encodeDelta(const std::uint32_t* image, const std::uint32_t* base, std::size_t words,
+                               std::uint32_t* out) {
+    std::size_t o = 0, i = 0;
+    while (i < words) {
+        std::size_t zeros = 0;
+        while (i < words && zeros < MAX_RUN && image[i] == (Keyframe ? 0 : base[i])) {
+            ++zeros;
+            ++i;
+        }
+        std::size_t token = o++;
+        std::size_t literals = 0;
+        while (i < words && literals < MAX_RUN && image[i] != (Keyframe ? 0 : base[i])) {
+            out[o++] = image[i] ^ (Keyframe ? 0 : base[i]);
+            ++literals;
+            ++i;
+        }
+        out[token] = (std::uint32_t)(zeros | literals << 16);
+    }
+    return o;
+}
+
+// XORs a delta stream into `image` in place
+static void applyDelta(const std::uint32_t* in, std::size_t inWords, std::uint32_t* image) {
+    std::size_t i = 0;
+    for (std::size_t o = 0; o < inWords;) {
+        std::uint32_t token = in[o++];
+        i += token & 0xffff;
+        for (std::size_t literals = token >> 16; literals > 0; --literals) {
+            image[i++] ^= in[o++];
+        }
+    }
+}
+
+RewindBuffer::RewindBuffer(std::size_t maxSnapshots, std::size_t arenaBytes, std::size_t keyframeInterval)
+    : arena(arenaBytes / 4), entries(std::max<std::size_t>(maxSnapshots, 1)),
+      keyframeInterval(std::max<std::size_t>(keyframeInterval, 1)) {
+}
+
+void RewindBuffer::clear() {
+    first = count = 0;
+    writePos = 0;
+    sinceKeyframe = 0;
+    previousWords = 0;
+    encodedWords = rawWords = 0;
+}
+
+void RewindBuffer::dropOldest() {
+    Entry& oldest = entryAt(0);
+    encodedWords -= oldest.words;
+    rawWords -= oldest.imageWords;
+    first = (first + 1) % entries.size();
+    --count;
+}
+
+// Deltas are useless without their keyframe, so they go with it
+void RewindBuffer::dropOldestGroup() {
+    dropOldest();
+    while (count > 0 && !entryAt(0).keyframe) {
+        dropOldest();
+    }
+}
+
+// Frees `words` contiguous words at writePos, wrapping to the start of
+// the arena when the end doesn't have room
+void RewindBuffer::makeRoom(std::size_t words) {
+    for (;;) {
+        if (count == 0) {
+            if (writePos + words > arena.size()) {
+                writePos = 0;
+            }
+            return;
+        }
+        std::size_t tail = entryAt(0).offset;
+        if (tail < writePos) {
+            // Free space is [writePos, end) and [0, tail)
+            if (writePos + words <= arena.size()) {
+                return;
+            }
+            if (words <= tail) {
+                writePos = 0;
+                return;
+            }
+        }
+        else if (writePos + words <= tail) {
+            return;
+        }
+        dropOldestGroup();
+    }
+}
+
+bool RewindBuffer::push(const World& world) {
+    std::size_t words = worldStateSize(world) / 4;
+    std::size_t worst = maxEncodedWords(words);
+    if (worst > arena.size()) {
+        return false;
+    }
+    current.resize(words);
+    previous.resize(words);
+    writeWorldState(world, reinterpret_cast<std::uint8_t*>(current.data()));
+
+    if (count == entries.size()) {
+        dropOldestGroup();
+    }
+    makeRoom(worst);
+
+    bool keyframe = count == 0 || sinceKeyframe + 1 >= keyframeInterval || previousWords != words;
+    std::size_t used = keyframe ? encodeDelta<true>(current.data(), nullptr, words, &arena[writePos])
+                                : encodeDelta<false>(current.data(), previous.data(), words, &arena[writePos]);
+    entryAt(count) = { writePos, used, words, keyframe };
+    ++count;
+    writePos += used;
+    encodedWords += used;
+    rawWords += words;
+    sinceKeyframe = keyframe ? 0 : sinceKeyframe + 1;
+
+    std::swap(current, previous);
+    previousWords = words;
+    return true;
+}
+
+bool RewindBuffer::rewind(World& world, std::size_t ticks) {
+    if (count == 0) {
+        return false;
+    }
+    ticks = std::min(ticks, count - 1);
+    while (ticks-- > 0) {
+        Entry& newest = entryAt(count - 1);
+        encodedWords -= newest.words;
+        rawWords -= newest.imageWords;
+        --count;
+    }
+    Entry& newest = entryAt(count - 1);
+    writePos = newest.offset + newest.words;
+
+    // Decode forward from the nearest keyframe into the newest image
+    std::size_t key = count - 1;
+    while (!entryAt(key).keyframe) {
+        --key;
+    }
+    previous.assign(newest.imageWords, 0);
+    for (std::size_t i = key; i < count; ++i) {
+        const Entry& entry = entryAt(i);
+        applyDelta(&arena[entry.offset], entry.words, previous.data());
+    }
+    sinceKeyframe = count - 1 - key;
+    previousWords = newest.imageWords;
+
+    return readWorldState(reinterpret_cast<const std::uint8_t*>(previous.data()), previous.size() * 4, world);
+}
@@ -0,0 +1,62 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "world.h"
+
+// Ring buffer of world images, one per tick, for instant rewind. Each
+// image is XORed with the one before it and the zero words run-length
+// encoded, so a tick where only the formation moved costs a small
+// fraction of a full image. Every keyframeInterval-th image is stored
+// against zero instead, which bounds how many deltas a restore decodes.
+//
+// All memory is allocated up front (the two working images on the first
+// push); when either the snapshot slots or the arena run out, the oldest
+// keyframe and its deltas are dropped together.
+class RewindBuffer {
+public:
+    RewindBuffer(std::size_t maxSnapshots, std::size_t arenaBytes, std::size_t keyframeInterval = 60);
+
+    void clear();
+
+    // Appends the world's current state; returns false if a single image
+    // can't fit in the arena
+    bool push(const World& world);
+
+    // Drops the newest `ticks` snapshots and restores the world to the
+    // newest one left; the oldest snapshot is always kept. Returns false
+    // if the buffer is empty.
+    bool rewind(World& world, std::size_t ticks);
+
+    std::size_t size() const { return count; }
+    std::size_t bytesUsed() const { return encodedWords * 4; }
+    // What the held snapshots would take uncompressed
+    std::size_t rawBytes() const { return rawWords * 4; }
+
+private:
+    struct Entry {
+        std::size_t offset;  // into the arena, in words
+        std::size_t words;   // encoded length
+        std::size_t imageWords;
+        bool keyframe;
+    };
+
+    Entry& entryAt(std::size_t i) { return entries[(first + i) % entries.size()]; }
+    void dropOldest();
+    void dropOldestGroup();
+    void makeRoom(std::size_t words);
+
+    std::vector<std::uint32_t> arena;
+    std::vector<Entry> entries;
+    std::size_t first = 0, count = 0;
+    std::size_t writePos = 0;
+    std::size_t keyframeInterval;
+    std::size_t sinceKeyframe = 0;
+    std::size_t encodedWords = 0, rawWords = 0;
+    std::size_t previousWords = 0;
+
+    // The image being encoded and the newest one held
+    std::vector<std::uint32_t> current, previous;
+};
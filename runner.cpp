@@ -0,0 +1,249 @@
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include "policy.h"
+#include "waves.h"
+#include "world.h"
+
+// Parallel headless runner: plays many independent games across all cores
+// with a scripted input policy and prints aggregate stats. No window, no
+// real-time pacing.
+// Usage: runner [--instances N] [--threads N] [--policy idle|random|bot]
+//               [--tuning NAME] [--seed N] [--max-ticks N] [--waves FILE]
+//               [--csv FILE]
+//
+// Instance i is seeded with seed + i, both its input policy and the game's
+// own random streams (enemy fire), so its result doesn't depend on the
+// thread count or on which worker ran it. Games still going after
+// --max-ticks are stopped and counted as unfinished.
+//
+// Scheduling is work stealing: instances are dealt round-robin into one
+// deque per worker, each worker pops from the back of its own deque and,
+// once it runs dry, steals from the front of the others'. A game takes
+// thousands of ticks, so a mutex per deque costs nothing measurable.
+
+struct InstanceResult {
+    int score = 0;
+    std::uint32_t ticks = 0;
+    Outcome outcome = Outcome::Playing;
+};
+
+struct WorkQueue {
+    std::mutex mutex;
+    std::deque<int> jobs;
+};
+
+struct WorkerStats {
+    int instances = 0;
+    int stolen = 0;
+    long long ticks = 0;
+    double seconds = 0.0;
+};
+
+struct RunConfig {
+    InputPolicy policy = randomPolicy;
+    std::uint32_t seed = 1;
+    std::uint32_t maxTicks = 100000;
+    TuningId tuning = TuningId::Classic;
+    const WaveSet* waves = nullptr;
+};
+
+static bool popJob(WorkQueue& queue, int& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = queue.jobs.back();
+    queue.jobs.pop_back();
+    return true;
+}
+
+static bool stealJob(WorkQueue& queue, int& job) {
+    std::lock_guard<std::mutex> lock(queue.mutex);
+    if (queue.jobs.empty()) {
+        return false;
+    }
+    job = queue.jobs.front();
+    queue.jobs.pop_front();
+    return true;
+}
+
+// Plays one game to the end; the world's storage is reused between games
+static InstanceResult runInstance(World& world, const RunConfig& config, std::uint32_t seed) {
+    PolicyState policy;
+    seedPolicy(policy, seed);
+    resetWorld(world, seed);
+
+    InstanceResult result;
+    while (result.outcome == Outcome::Playing && world.tick < config.maxTicks) {
+        stepWorld(world, config.policy(world, policy));
+        result.outcome = checkOutcome(world);
+    }
+    result.score = world.score;
+    result.ticks = world.tick;
+    return result;
+}
+
+static void work(int self, std::vector<WorkQueue>& queues, const RunConfig& config,
+                 std::vector<InstanceResult>& results, WorkerStats& stats) {
+    World world;
+    setTuning(world, config.tuning);
+    world.waves = config.waves;
+    auto start = std::chrono::steady_clock::now();
+    int count = (int)queues.size();
+    for (;;) {
+        int job;
+        bool found = popJob(queues[self], job);
+        // Nothing new is ever queued, so one empty pass means we're done
+        for (int k = 1; !found && k < count; ++k) {
+            found = stealJob(queues[(self + k) % count], job);
+            stats.stolen += found;
+        }
+        if (!found) {
+            break;
+        }
+
+        results[job] = runInstance(world, config, config.seed + (std::uint32_t)job);
+        ++stats.instances;
+        stats.ticks += results[job].ticks;
+    }
+    stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool writeCsv(const char* path, const std::vector<InstanceResult>& results, std::uint32_t seed) {
+    std::FILE* file = std::fopen(path, "w");
+    if (file == nullptr) {
+        return false;
+    }
+    std::fprintf(file, "instance,seed,outcome,score,ticks\n");
+    for (std::size_t i = 0; i < results.size(); ++i) {
+        const InstanceResult& r = results[i];
+        const char* outcome = r.outcome == Outcome::Won ? "won" : r.outcome == Outcome::Lost ? "lost" : "unfinished";
+        std::fprintf(file, "%zu,%u,%s,%d,%u\n", i, seed + (std::uint32_t)i, outcome, r.score, r.ticks);
+    }
+    return std::fclose(file) == 0;
+}
+
+int main(int argc, char** argv) {
+    int instances = 1000;
+    int threads = (int)std::max(1u, std::thread::hardware_concurrency());
+    const char* policyName = "random";
+    const char* csvPath = nullptr;
+    const char* wavesPath = nullptr;
+    RunConfig config;
+
+    for (int i = 1; i < argc; ++i) {
+        if (std::strcmp(argv[i], "--instances") == 0 && i + 1 < argc) {
+            instances = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            threads = std::atoi(argv[++i]);
+        }
+        else if (std::strcmp(argv[i], "--policy") == 0 && i + 1 < argc) {
+            policyName = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--tuning") == 0 && i + 1 < argc) {
+            if (!findTuning(argv[++i], config.tuning)) {
+                std::fprintf(stderr, "unknown tuning: %s\n", argv[i]);
+                return 2;
+            }
+        }
+        else if (std::strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config.seed = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--max-ticks") == 0 && i + 1 < argc) {
+            config.maxTicks = (std::uint32_t)std::strtoul(argv[++i], nullptr, 10);
+        }
+        else if (std::strcmp(argv[i], "--waves") == 0 && i + 1 < argc) {
+            wavesPath = argv[++i];
+        }
+        else if (std::strcmp(argv[i], "--csv") == 0 && i + 1 < argc) {
+            csvPath = argv[++i];
+        }
+        else {
+            std::fprintf(stderr, "usage: %s [--instances N] [--threads N] [--policy idle|random|bot]\n"
+                                 "       [--tuning NAME] [--seed N] [--max-ticks N] [--waves FILE]\n"
+                                 "       [--csv FILE]\n", argv[0]);
+            return 2;
+        }
+    }
+    config.policy = findPolicy(policyName);
+    if (config.policy == nullptr) {
+        std::fprintf(stderr, "unknown policy: %s\n", policyName);
+        return 2;
+    }
+    WaveSet waves = defaultWaves(config.tuning);
+    std::string error;
+    if (wavesPath != nullptr && !loadWaves(wavesPath, waves, error)) {
+        std::fprintf(stderr, "%s\n", error.c_str());
+        return 1;
+    }
+    config.waves = &waves;
+    instances = std::max(instances, 0);
+    threads = std::max(1, std::min(threads, std::max(instances, 1)));
+
+    std::vector<WorkQueue> queues(threads);
+    for (int job = 0; job < instances; ++job) {
+        queues[job % threads].jobs.push_back(job);
+    }
+    std::vector<InstanceResult> results(instances);
+    std::vector<WorkerStats> stats(threads);
+
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> workers;
+    for (int t = 1; t < threads; ++t) {
+        workers.emplace_back(work, t, std::ref(queues), std::cref(config), std::ref(results), std::ref(stats[t]));
+    }
+    work(0, queues, config, results, stats[0]);
+    for (std::thread& worker : workers) {
+        worker.join();
+    }
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    int wins = 0, losses = 0;
+    long long scoreSum = 0, tickSum = 0;
+    int minScore = 0, maxScore = 0;
+    std::uint32_t minTicks = 0, maxTicks = 0;
+    for (int i = 0; i < instances; ++i) {
+        const InstanceResult& r = results[i];
+        wins += r.outcome == Outcome::Won;
+        losses += r.outcome == Outcome::Lost;
+        scoreSum += r.score;
+        tickSum += r.ticks;
+        minScore = i == 0 ? r.score : std::min(minScore, r.score);
+        maxScore = i == 0 ? r.score : std::max(maxScore, r.score);
+        minTicks = i == 0 ? r.ticks : std::min(minTicks, r.ticks);
+        maxTicks = i == 0 ? r.ticks : std::max(maxTicks, r.ticks);
+    }
+
+    std::printf("policy: %s, tuning: %s, %d instances on %d threads\n", policyName, tuningName(config.tuning),
+                instances, threads);
+    std::printf("outcomes: won %d, lost %d, unfinished %d\n", wins, losses, instances - wins - losses);
+    std::printf("score: mean %.1f, min %d, max %d\n", instances > 0 ? (double)scoreSum / instances : 0.0, minScore,
+                maxScore);
+    std::printf("survival ticks: mean %.1f, min %u, max %u\n", instances > 0 ? (double)tickSum / instances : 0.0,
+                minTicks, maxTicks);
+    std::printf("elapsed: %.3f s\n", seconds);
+    std::printf("ticks/sec: %.0f total, %.0f per thread\n", seconds > 0 ? tickSum / seconds : 0.0,
+                seconds > 0 ? tickSum / seconds / threads : 0.0);
+    for (int t = 0; t < threads; ++t) {
+        const WorkerStats& s = stats[t];
+        std::printf("  worker %d: %d instances (%d stolen), %lld ticks, %.0f ticks/sec\n", t, s.instances, s.stolen,
+                    s.ticks, s.seconds > 0 ? s.ticks / s.seconds : 0.0);
+    }
+
+    if (csvPath != nullptr && !writeCsv(csvPath, results, config.seed)) {
+        std::fprintf(stderr, "could not write %s\n", csvPath);
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,173 @@
+#include "scene.h"
+
+#include <algorithm>
+#include <string>
+
+// Tells the second ship apart from the first in two-player games
+static const sf::Color PLAYER2_TINT(120, 200, 255);
+
+static void centerText(sf::Text& text, float y) {
+    sf::FloatRect bounds = text.getLocalBounds();
+    text.setPosition(WINDOW_WIDTH / 2 - bounds.width / 2, y);
+}
+
+// Fills in the end screen message once, when the game is won or lost
+static void showEndScreen(GameState state, int score, sf::Text& messageText) {
+    if (state == GameState::Won) {
+        messageText.setString("    You Win!\nFinal Score: " + std::to_string(score));
+        messageText.setFillColor(sf::Color::Green);
+    }
+    else {
+        messageText.setString("   Game Over!\nFinal Score: " + std::to_string(score));
+        messageText.setFillColor(sf::Color::Red);
+    }
+    centerText(messageText, WINDOW_HEIGHT / 2 - messageText.getLocalBounds().height / 2);
+}
+
+Scene::Scene(const GameAssets& assets, bool cacheLayers)
+    : assets(assets), renderer(assets.enemyTexture), titleText("Space Invaders", assets.font, 50),
+      instructionText("Loading...", assets.font, 30), messageText("", assets.font, 20),
+      promptText("Enter to play again, Esc to quit", assets.font, 20), profileText("", assets.font, 14),
+      scoreText(assets.font, 20, "Score: "), cacheLayers(cacheLayers) {
+    scoreText.setPosition(10, 10);
+
+    titleText.setFillColor(sf::Color::Red);
+    centerText(titleText, WINDOW_HEIGHT / 3);
+
+    instructionText.setFillColor(sf::Color::White);
+    centerText(instructionText, WINDOW_HEIGHT / 2);
+
+    promptText.setFillColor(sf::Color::White);
+    centerText(promptText, WINDOW_HEIGHT * 2 / 3);
+
+    profileText.setFillColor(sf::Color::Yellow);
+    profileText.setPosition(WINDOW_WIDTH - 300, 10);
+}
+
+void Scene::sync(const FrameSnapshot& frame) {
+    // The textures are uploaded before the first frame that says so
+    if (frame.assetsReady && !texturesBound) {
+        background.setTexture(assets.backgroundTexture, true);
+        player.setTexture(assets.playerTexture, true);
+        instructionText.setString("Press Enter to Start");
+        centerText(instructionText, WINDOW_HEIGHT / 2);
+        texturesBound = true;
+        backdrop.invalidate();
+    }
+    scoreText.setValue(frame.score);
+    if (frame.state != shownState) {
+        if (frame.state == GameState::Won || frame.state == GameState::Lost) {
+            showEndScreen(frame.state, frame.score, messageText);
+        }
+        shownState = frame.state;
+        backdrop.invalidate();
+    }
+    bool prompt = frame.stateTime >= END_SCREEN_SECONDS;
+    if (prompt != shownPrompt) {
+        shownPrompt = prompt;
+        backdrop.invalidate();
+    }
+    if (frame.showProfile && frame.profileVersion != shownProfileVersion) {
+        profileText.setString(frame.profileText);
+        shownProfileVersion = frame.profileVersion;
+    }
+}
+
+void Scene::fill(const sf::FloatRect& bounds) {
+    float width = std::min(bounds.left + bounds.width, (float)WINDOW_WIDTH) - std::max(bounds.left, 0.0f);
+    float height = std::min(bounds.top + bounds.height, (float)WINDOW_HEIGHT) - std::max(bounds.top, 0.0f);
+    if (width > 0 && height > 0) {
+        pixels += (long long)(width * height);
+    }
+}
+
+int Scene::drawBackdrop(sf::RenderTarget& target, const FrameSnapshot& frame) {
+    target.clear();
+    fill(sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT));
+
+    if (frame.state == GameState::Menu) {
+        target.draw(titleText);
+        target.draw(instructionText);
+        fill(titleText.getGlobalBounds());
+        fill(instructionText.getGlobalBounds());
+        return 2;
+    }
+    else if (frame.state == GameState::Won || frame.state == GameState::Lost) {
+        target.draw(messageText);
+        fill(messageText.getGlobalBounds());
+        if (shownPrompt) {
+            target.draw(promptText);
+            fill(promptText.getGlobalBounds());
+        }
+        return 2;
+    }
+    target.draw(background);
+    fill(background.getGlobalBounds());
+    return 1;
+}
+
+int Scene::draw(sf::RenderTarget& target, const FrameSnapshot& frame, float alpha) {
+    sync(frame);
+    pixels = 0;
+    int drawCalls = 0;
+
+    // The backdrop replaces clearing the frame either way
+    if (cacheLayers && backdrop.dirty()) {
+        sf::RenderTarget* layer = backdrop.begin(WINDOW_WIDTH, WINDOW_HEIGHT);
+        if (layer != nullptr) {
+            drawCalls += drawBackdrop(*layer, frame);
+            backdrop.end();
+        }
+        else {
+            cacheLayers = false;
+        }
+    }
+    if (cacheLayers) {
+        drawCalls += backdrop.composite(target);
+        fill(sf::FloatRect(0, 0, WINDOW_WIDTH, WINDOW_HEIGHT));
+    }
+    else {
+        drawCalls += drawBackdrop(target, frame);
+    }
+
+    if (frame.state != GameState::Menu && frame.state != GameState::Won && frame.state != GameState::Lost) {
+        // Snapshots hold the newest tick; step back towards the one before
+        float back = 1.0f - alpha;
+        player.setPosition(frame.playerX - back * frame.playerStepX, frame.playerY);
+        player.setColor(sf::Color::White);
+        target.draw(player);
+        fill(player.getGlobalBounds());
+        // The second ship is the same sprite, tinted
+        if (frame.players == 2) {
+            player.setPosition(frame.player2X - back * frame.player2StepX, frame.playerY);
+            player.setColor(PLAYER2_TINT);
+            target.draw(player);
+            fill(player.getGlobalBounds());
+            ++drawCalls;
+        }
+
+        renderer.build(frame.bullets, -back * frame.bulletStepY, frame.enemies, -back * frame.enemyStepX,
+                       -back * frame.enemyStepY);
+        std::size_t shots = renderer.addParticles(frame.shots, back);
+        std::size_t debris = renderer.addParticles(frame.debris, back);
+        drawCalls += renderer.submit(target);
+        pixels += (long long)(shots * SHOT_WIDTH * SHOT_HEIGHT + debris * DEBRIS_SIZE * DEBRIS_SIZE);
+        for (std::size_t i = 0; i < frame.bullets.size(); ++i) {
+            pixels += (long long)(frame.bullets.w[i] * frame.bullets.h[i]);
+        }
+        for (std::size_t i = 0; i < frame.enemies.size(); ++i) {
+            pixels += (long long)(frame.enemies.w[i] * frame.enemies.h[i]);
+        }
+
+        drawCalls += scoreText.draw(target);
+        pixels += (long long)scoreText.area();
+        ++drawCalls; // player
+    }
+
+    if (frame.showProfile) {
+        target.draw(profileText);
+        fill(profileText.getGlobalBounds());
+        ++drawCalls;
+    }
+    return drawCalls;
+}
@@ -0,0 +1,52 @@
+#pragma once
+
+#include <SFML/Graphics.hpp>
+
+#include "assets.h"
+#include "frame.h"
+#include "layers.h"
+#include "renderer.h"
+
+// How long the result is shown before the play-again prompt appears
+const float END_SCREEN_SECONDS = 3.0f;
+
+// Draws frame snapshots: the menu, the end screens or the game itself.
+// Owns every sprite and text it draws and only updates them from the
+// snapshot, so it can run on a render thread while the game updates.
+//
+// Whatever doesn't move on the current screen (the background, or the
+// menu and end screen texts) is the backdrop. With cacheLayers it is
+// drawn into an offscreen layer when it changes and composited in one
+// unblended pass each frame; otherwise it is cleared and redrawn.
+class Scene {
+public:
+    Scene(const GameAssets& assets, bool cacheLayers = true);
+
+    // Draws the frame with moving things placed `alpha` of the way from
+    // the previous tick to the newest one; returns the draw calls issued
+    int draw(sf::RenderTarget& target, const FrameSnapshot& frame, float alpha);
+
+    // Pixels covered by everything the last draw() filled, offscreen
+    // layer updates included
+    long long pixelsFilled() const { return pixels; }
+
+private:
+    void sync(const FrameSnapshot& frame);
+    int drawBackdrop(sf::RenderTarget& target, const FrameSnapshot& frame);
+    void fill(const sf::FloatRect& bounds);
+
+    const GameAssets& assets;
+    BatchRenderer renderer;
+    sf::Sprite background, player;
+    sf::Text titleText, instructionText, messageText, promptText, profileText;
+    CounterText scoreText;
+    CachedLayer backdrop;
+    bool cacheLayers;
+    long long pixels = 0;
+
+    // What the texts and the backdrop currently show
+    bool texturesBound = false;
+    GameState shownState = GameState::Menu;
+    bool shownPrompt = false;
+    int shownProfileVersion = 0;
+};
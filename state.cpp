@@ -0,0 +1,218 @@
+#include "state.h"
+
+#include <cstdio>
+#include <cstring>
+#include <vector>
+
+#include "waves.h"
+
+static const char STATE_MAGIC[4] = { 'S', 'W', 'S', 'T' };
+static const std::uint32_t STATE_VERSION = 6;
+
+static std::size_t arraysSize(std::size_t capacity) {
+    std::size_t bytes = capacity * (4 * sizeof(float) + 1);
+    return (bytes + 3) & ~(std::size_t)3;
+}
+
+static std::size_t shotsSize(std::size_t capacity) {
+    std::size_t bytes = capacity * (4 * sizeof(float) + sizeof(std::uint16_t) + 1);
+    return (bytes + 3) & ~(std::size_t)3;
+}
+
+static std::size_t imageSize(std::size_t bulletCapacity, std::size_t enemyCapacity, std::size_t shotCapacity) {
+    return sizeof(WorldStateHeader) + arraysSize(bulletCapacity) + arraysSize(enemyCapacity) + shotsSize(shotCapacity);
+}
+
+std::size_t worldStateSize(const World& world) {
+    return imageSize(world.bullets.capacity, world.enemies.capacity, world.shots.capacity);
+}
+
+static std::uint8_t* writeArrays(const EntityArrays& entities, std::uint8_t* out) {
+    std::size_t n = entities.size(), cap = entities.capacity;
+    const std::vector<float>* columns[4] = { &entities.x, &entities.y, &entities.w, &entities.h };
+    for (const std::vector<float>* column : columns) {
+        std::memcpy(out, column->data(), n * sizeof(float));
+        std::memset(out + n * sizeof(float), 0, (cap - n) * sizeof(float));
+        out += cap * sizeof(float);
+    }
+    std::memcpy(out, entities.alive.data(), n);
+    std::size_t tail = arraysSize(cap) - cap * 4 * sizeof(float);
+    std::memset(out + n, 0, tail - n);
+    return out + tail;
+}
+
+static const std::uint8_t* readArrays(const std::uint8_t* in, std::size_t count, std::size_t capacity,
+                                      EntityArrays& entities) {
+    entities.reserve(capacity);
+    std::vector<float>* columns[4] = { &entities.x, &entities.y, &entities.w, &entities.h };
+    for (std::vector<float>* column : columns) {
+        column->resize(count);
+        std::memcpy(column->data(), in, count * sizeof(float));
+        in += capacity * sizeof(float);
+    }
+    entities.alive.assign(in, in + count);
+    return in + (arraysSize(capacity) - capacity * 4 * sizeof(float));
+}
+
+static void writeShots(const ParticlePool& shots, std::uint8_t* out) {
+    std::size_t cap = shots.capacity;
+    const std::vector<float>* columns[4] = { &shots.x, &shots.y, &shots.vx, &shots.vy };
+    for (const std::vector<float>* column : columns) {
+        std::memcpy(out, column->data(), cap * sizeof(float));
+        out += cap * sizeof(float);
+    }
+    std::memcpy(out, shots.life.data(), cap * sizeof(std::uint16_t));
+    out += cap * sizeof(std::uint16_t);
+    std::memcpy(out, shots.shade.data(), cap);
+    std::size_t tail = shotsSize(cap) - cap * (4 * sizeof(float) + sizeof(std::uint16_t));
+    std::memset(out + cap, 0, tail - cap);
+}
+
+static void readShots(const std::uint8_t* in, std::size_t capacity, ParticlePool& shots) {
+    if (shots.capacity != capacity) {
+        shots.reserve(capacity, SHOT_WIDTH, SHOT_HEIGHT);
+    }
+    std::vector<float>* columns[4] = { &shots.x, &shots.y, &shots.vx, &shots.vy };
+    for (std::vector<float>* column : columns) {
+        std::memcpy(column->data(), in, capacity * sizeof(float));
+        in += capacity * sizeof(float);
+    }
+    std::memcpy(shots.life.data(), in, capacity * sizeof(std::uint16_t));
+    in += capacity * sizeof(std::uint16_t);
+    std::memcpy(shots.shade.data(), in, capacity);
+}
+
+void writeWorldState(const World& world, std::uint8_t* out) {
+    WorldStateHeader header;
+    std::memcpy(header.magic, STATE_MAGIC, 4);
+    header.version = STATE_VERSION;
+    header.tick = world.tick;
+    header.score = world.score;
+    header.wave = world.wave;
+    header.waveTick = world.waveTick;
+    header.nextSpawn = world.nextSpawn;
+    header.waveKills = world.waveKills;
+    header.playerX = world.playerX;
+    header.playerY = world.playerY;
+    header.playerWidth = world.playerWidth;
+    header.playerHeight = world.playerHeight;
+    header.enemyWidth = world.enemyWidth;
+    header.enemyHeight = world.enemyHeight;
+    header.shootTimer = world.shootTimer;
+    header.enemyDirection = world.enemyDirection;
+    header.enemySpeed = world.enemySpeed;
+    header.playerStepX = world.playerStepX;
+    header.enemyStepX = world.enemyStepX;
+    header.enemyStepY = world.enemyStepY;
+    header.bulletCount = (std::uint32_t)world.bullets.size();
+    header.bulletCapacity = (std::uint32_t)world.bullets.capacity;
+    header.enemyCount = (std::uint32_t)world.enemies.size();
+    header.enemyCapacity = (std::uint32_t)world.enemies.capacity;
+    header.rng = world.rng;
+    header.seed = world.seed;
+    header.shotHead = world.shots.head;
+    header.shotCount = world.shots.count;
+    header.shotCapacity = world.shots.capacity;
+    header.playerHit = world.playerHit;
+    header.tuning = (std::uint32_t)world.tuning;
+    header.players = (std::uint32_t)world.players;
+    header.player2X = world.player2X;
+    header.player2StepX = world.player2StepX;
+    header.shootTimer2 = world.shootTimer2;
+    header.padding = 0;
+    std::memcpy(out, &header, sizeof(header));
+
+    out = writeArrays(world.bullets, out + sizeof(header));
+    out = writeArrays(world.enemies, out);
+    writeShots(world.shots, out);
+}
+
+bool readWorldState(const std::uint8_t* data, std::size_t size, World& world) {
+    WorldStateHeader header;
+    if (size < sizeof(header)) {
+        return false;
+    }
+    std::memcpy(&header, data, sizeof(header));
+    if (std::memcmp(header.magic, STATE_MAGIC, 4) != 0 || header.version != STATE_VERSION ||
+        header.tuning != (std::uint32_t)world.tuning || header.players != (std::uint32_t)world.players ||
+        header.bulletCount > header.bulletCapacity || header.enemyCount > header.enemyCapacity ||
+        header.shotCapacity > MAX_PARTICLES ||
+        (header.shotCapacity & (header.shotCapacity - 1)) != 0 || header.shotCount > header.shotCapacity ||
+        (header.shotCapacity > 0 && header.shotHead >= header.shotCapacity) ||
+        size != imageSize(header.bulletCapacity, header.enemyCapacity, header.shotCapacity)) {
+        return false;
+    }
+    const WaveSet& waves = activeWaves(world);
+    if (header.wave >= waves.waves.size() || header.nextSpawn < waves.waves[header.wave].firstSpawn ||
+        header.nextSpawn > waves.waves[header.wave].firstSpawn + waves.waves[header.wave].spawnCount) {
+        return false;
+    }
+
+    world.tick = header.tick;
+    world.score = header.score;
+    world.wave = header.wave;
+    world.waveTick = header.waveTick;
+    world.nextSpawn = header.nextSpawn;
+    world.waveKills = header.waveKills;
+    world.playerX = header.playerX;
+    world.playerY = header.playerY;
+    world.playerWidth = header.playerWidth;
+    world.playerHeight = header.playerHeight;
+    world.enemyWidth = header.enemyWidth;
+    world.enemyHeight = header.enemyHeight;
+    world.shootTimer = header.shootTimer;
+    world.enemyDirection = header.enemyDirection;
+    world.enemySpeed = header.enemySpeed;
+    world.playerStepX = header.playerStepX;
+    world.enemyStepX = header.enemyStepX;
+    world.enemyStepY = header.enemyStepY;
+    world.bulletCapacity = header.bulletCapacity;
+    world.rng = header.rng;
+    world.seed = header.seed;
+    world.playerHit = header.playerHit != 0;
+    world.player2X = header.player2X;
+    world.player2StepX = header.player2StepX;
+    world.shootTimer2 = header.shootTimer2;
+    world.shotCapacity = header.shotCapacity;
+
+    const std::uint8_t* in = readArrays(data + sizeof(header), header.bulletCount, header.bulletCapacity, world.bullets);
+    in = readArrays(in, header.enemyCount, header.enemyCapacity, world.enemies);
+    readShots(in, header.shotCapacity, world.shots);
+    world.shots.head = header.shotHead;
+    world.shots.count = header.shotCount;
+    world.debris.clear();
+
+    // The broadphase is derived state; refile every enemy
+    world.enemyGrid.reset(header.enemyCapacity);
+    for (std::size_t j = 0; j < world.enemies.size(); ++j) {
+        world.enemyGrid.update((int)j, world.enemies.x[j], world.enemies.y[j]);
+    }
+    return true;
+}
+
+bool saveWorldState(const char* path, const World& world) {
+    std::vector<std::uint8_t> image(worldStateSize(world));
+    writeWorldState(world, image.data());
+
+    std::FILE* file = std::fopen(path, "wb");
+    if (file == nullptr) {
+        return false;
+    }
+    bool written = std::fwrite(image.data(), 1, image.size(), file) == image.size();
+    return std::fclose(file) == 0 && written;
+}
+
+bool loadWorldState(const char* path, World& world) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        return false;
+    }
+    std::vector<std::uint8_t> image;
+    std::uint8_t buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        image.insert(image.end(), buffer, buffer + n);
+    }
+    std::fclose(file);
+    return readWorldState(image.data(), image.size(), world);
+}
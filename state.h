@@ -0,0 +1,58 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+#include "world.h"
+
+// Flat image of everything that affects future ticks: a fixed POD header
+// followed by the bullet, enemy and shot arrays laid out at full capacity, so
+// every field sits at the same offset from one tick to the next (which is
+// what lets the rewind buffer delta-compress consecutive images). Images
+// are native byte order; they're for quick saves on the same machine,
+// unlike replay logs.
+//
+// Layout:
+//   WorldStateHeader
+//   bullets: f32 x[cap], y[cap], w[cap], h[cap], u8 alive[cap]
+//   enemies: the same
+//   shots: f32 x[cap], y[cap], vx[cap], vy[cap], u16 life[cap], u8 shade[cap]
+// with bullet and enemy slots past the count zeroed and each array group
+// padded to 4 bytes. Shots are stored slot for slot, ring position and all.
+// Explosion debris is left out; loading clears it.
+
+struct WorldStateHeader {
+    char magic[4];
+    std::uint32_t version;
+    std::uint32_t tick;
+    std::int32_t score;
+    std::uint32_t wave, waveTick, nextSpawn, waveKills;
+    float playerX, playerY, playerWidth, playerHeight;
+    float enemyWidth, enemyHeight;
+    float shootTimer, enemyDirection, enemySpeed;
+    float playerStepX, enemyStepX, enemyStepY;
+    std::uint32_t bulletCount, bulletCapacity;
+    std::uint32_t enemyCount, enemyCapacity;
+    std::uint64_t rng, seed;
+    std::uint32_t shotHead, shotCount, shotCapacity;
+    std::uint32_t playerHit;
+    std::uint32_t tuning;
+    std::uint32_t players;
+    float player2X, player2StepX, shootTimer2;
+    std::uint32_t padding; // zero, so no byte of the header is left unset
+};
+
+// Size in bytes of the world's image; always a multiple of 4
+std::size_t worldStateSize(const World& world);
+
+// Writes worldStateSize(world) bytes to `out`
+void writeWorldState(const World& world, std::uint8_t* out);
+
+// Restores a world from an image, reusing its storage; returns false and
+// leaves the world alone if the image is malformed, was saved under a
+// different tuning or player count, or its wave progress doesn't fit the
+// world's waves
+bool readWorldState(const std::uint8_t* data, std::size_t size, World& world);
+
+bool saveWorldState(const char* path, const World& world);
+bool loadWorldState(const char* path, World& world);
@@ -0,0 +1,19 @@
+#include "tuning.h"
+
+#include <cstring>
+
+static const char* const TUNING_NAMES[TUNING_COUNT] = { "classic", "dense", "stress" };
+
+const char* tuningName(TuningId id) {
+    return (int)id < TUNING_COUNT ? TUNING_NAMES[(int)id] : "classic";
+}
+
+bool findTuning(const char* name, TuningId& id) {
+    for (int i = 0; i < TUNING_COUNT; ++i) {
+        if (std::strcmp(name, TUNING_NAMES[i]) == 0) {
+            id = (TuningId)i;
+            return true;
+        }
+    }
+    return false;
+}
@@ -0,0 +1,125 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+
+// Game tuning. A tuning is a type whose members are all compile-time
+// constants. The per-tick update and collision functions in world.cpp are
+// templates over it, instantiated once per tuning, so each tuning's
+// numbers fold straight into its own copy of the code. A world picks its
+// tuning at run time through World::tuning.
+//
+// Only what stays fixed for a whole game belongs here; anything that
+// changes while playing (enemy speed, timers, the random stream) is World
+// state.
+
+// Screen size, the same for every tuning
+const int WINDOW_WIDTH = 800;
+const int WINDOW_HEIGHT = 600;
+
+// The original game
+struct ClassicTuning {
+    static constexpr float PLAYER_SPEED = 300.0f; // px/s
+    static constexpr float BULLET_SPEED = 500.0f; // px/s
+    static constexpr float SHOOT_COOLDOWN = 0.5f; // s between player shots
+    static constexpr float ENEMY_DROP = 10.0f;    // px, each time the formation turns
+    static constexpr int SCORE_PER_KILL = 10;
+    static constexpr std::size_t BULLET_CAPACITY = 64;
+
+    // Enemy fire: every ENEMY_FIRE_INTERVAL ticks, ENEMY_VOLLEY random
+    // enemies shoot straight down
+    static constexpr std::uint32_t ENEMY_FIRE_INTERVAL = 40;
+    static constexpr int ENEMY_VOLLEY = 1;
+    static constexpr float ENEMY_SHOT_SPEED = 240.0f; // px/s
+    static constexpr std::size_t SHOT_CAPACITY = 1024;
+
+    // Explosion debris
+    static constexpr int DEBRIS_PER_EXPLOSION = 24;
+    static constexpr float DEBRIS_SPEED = 180.0f;    // px/s, at most
+    static constexpr std::uint16_t DEBRIS_LIFE = 45; // ticks, at most
+    static constexpr std::size_t DEBRIS_CAPACITY = 4096;
+
+    // Built-in waves (see waves.h for the format); a wave file replaces them
+    static constexpr const char* WAVES =
+        "wave\n"
+        "speed 100 200\n"
+        "formation 0 100 50 60 40\n"
+        "oooooooo\n"
+        "oooooooo\n"
+        "oooooooo\n"
+        "oooooooo\n";
+};
+
+// A packed 12x8 formation that fires twice as often
+struct DenseTuning : ClassicTuning {
+    static constexpr float SHOOT_COOLDOWN = 0.3f;
+    static constexpr std::uint32_t ENEMY_FIRE_INTERVAL = 20;
+
+    static constexpr const char* WAVES =
+        "wave\n"
+        "speed 60 220\n"
+        "formation 0 40 40 56 38\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n"
+        "oooooooooooo\n";
+};
+
+// Everything at once, for soak tests and benchmarks rather than play:
+// 140 enemies, a volley every tick and heavy debris
+struct StressTuning : ClassicTuning {
+    static constexpr float SHOOT_COOLDOWN = 0.0f;
+    static constexpr std::size_t BULLET_CAPACITY = 128;
+    static constexpr std::uint32_t ENEMY_FIRE_INTERVAL = 1;
+    static constexpr int ENEMY_VOLLEY = 16;
+    static constexpr std::size_t SHOT_CAPACITY = 4096;
+    static constexpr int DEBRIS_PER_EXPLOSION = 96;
+    static constexpr std::size_t DEBRIS_CAPACITY = 65536;
+
+    static constexpr const char* WAVES =
+        "wave\n"
+        "speed 80 300\n"
+        "formation 0 20 30 52 37\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n"
+        "oooooooooooooo\n";
+};
+
+// Run-time name for a tuning, as stored in worlds, saves and replay logs
+enum class TuningId : std::uint8_t {
+    Classic,
+    Dense,
+    Stress
+};
+
+const int TUNING_COUNT = 3;
+
+// Calls fn with a value of the tuning type `id` names, so run-time code can
+// reach the compile-time constants: withTuning(id, [](auto t) { ... })
+template <typename Fn>
+auto withTuning(TuningId id, Fn&& fn) {
+    switch (id) {
+    case TuningId::Dense:
+        return fn(DenseTuning());
+    case TuningId::Stress:
+        return fn(StressTuning());
+    default:
+        return fn(ClassicTuning());
+    }
+}
+
+// "classic", "dense" or "stress"
+const char* tuningName(TuningId id);
+// Looks a tuning up by name; false if unknown
+bool findTuning(const char* name, TuningId& id);
@@ -0,0 +1,189 @@
+#include "udp.h"
+
+#include <chrono>
+#include <cstring>
+
+#ifdef _WIN32
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef int socklen_t;
+#else
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#endif
+
+// Datagrams the shim can hold back at once
+static const std::size_t MAX_PENDING = 256;
+
+static std::int64_t nowMicros() {
+    auto now = std::chrono::steady_clock::now().time_since_epoch();
+    return std::chrono::duration_cast<std::chrono::microseconds>(now).count();
+}
+
+static void closeSocket(long long handle) {
+#ifdef _WIN32
+    closesocket((SOCKET)handle);
+#else
+    ::close((int)handle);
+#endif
+}
+
+UdpPeer::UdpPeer() : pending(MAX_PENDING) {
+}
+
+UdpPeer::~UdpPeer() {
+    close();
+}
+
+bool UdpPeer::open(int localPort, const char* peer, std::string& error) {
+    close();
+#ifdef _WIN32
+    static bool started = [] {
+        WSADATA data;
+        return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+    }();
+    if (!started) {
+        error = "could not start Winsock";
+        return false;
+    }
+#endif
+
+    std::string address = peer;
+    std::size_t colon = address.rfind(':');
+    if (colon == std::string::npos) {
+        error = address + ": expected host:port";
+        return false;
+    }
+    addrinfo hints;
+    std::memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    addrinfo* found = nullptr;
+    if (getaddrinfo(address.substr(0, colon).c_str(), address.substr(colon + 1).c_str(), &hints, &found) != 0 ||
+        found == nullptr) {
+        error = address + ": can't resolve";
+        return false;
+    }
+    const sockaddr_in* resolved = (const sockaddr_in*)found->ai_addr;
+    peerAddress = resolved->sin_addr.s_addr;
+    peerPort = resolved->sin_port;
+    freeaddrinfo(found);
+
+    long long s = (long long)socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (s < 0) {
+        error = "can't create a UDP socket";
+        return false;
+    }
+    sockaddr_in local;
+    std::memset(&local, 0, sizeof(local));
+    local.sin_family = AF_INET;
+    local.sin_addr.s_addr = htonl(INADDR_ANY);
+    local.sin_port = htons((std::uint16_t)localPort);
+#ifdef _WIN32
+    u_long nonBlocking = 1;
+    bool configured = ioctlsocket((SOCKET)s, FIONBIO, &nonBlocking) == 0;
+#else
+    bool configured = fcntl((int)s, F_SETFL, fcntl((int)s, F_GETFL, 0) | O_NONBLOCK) == 0;
+#endif
+    if (!configured || bind(s, (const sockaddr*)&local, sizeof(local)) != 0) {
+        closeSocket(s);
+        error = "can't bind UDP port " + std::to_string(localPort);
+        return false;
+    }
+    handle = s;
+    return true;
+}
+
+void UdpPeer::close() {
+    if (handle >= 0) {
+        closeSocket(handle);
+        handle = -1;
+    }
+    pendingCount = 0;
+}
+
+void UdpPeer::setShim(const LinkShim& settings, std::uint32_t seed) {
+    shim = settings;
+    rng = seed != 0 ? seed : 1;
+}
+
+// In [0, 1); xorshift, so runs with the same seed drop the same datagrams
+float UdpPeer::random() {
+    rng ^= rng << 13;
+    rng ^= rng >> 17;
+    rng ^= rng << 5;
+    return (rng >> 8) * (1.0f / 16777216.0f);
+}
+
+void UdpPeer::transmit(const std::uint8_t* data, std::size_t size) {
+    sockaddr_in to;
+    std::memset(&to, 0, sizeof(to));
+    to.sin_family = AF_INET;
+    to.sin_addr.s_addr = peerAddress;
+    to.sin_port = peerPort;
+    sendto(handle, (const char*)data, (int)size, 0, (const sockaddr*)&to, sizeof(to));
+}
+
+void UdpPeer::send(const std::uint8_t* data, std::size_t size) {
+    if (handle < 0 || size > MAX_DATAGRAM) {
+        return;
+    }
+    ++datagramsSent;
+    bytesSent += (long long)size;
+    if (shim.loss > 0.0f && random() < shim.loss) {
+        ++datagramsDropped;
+        return;
+    }
+    if (shim.delayMs <= 0.0f && shim.jitterMs <= 0.0f) {
+        transmit(data, size);
+        return;
+    }
+    if (pendingCount == pending.size()) {
+        ++datagramsDropped;
+        return;
+    }
+    Pending& p = pending[pendingCount++];
+    p.dueMicros = nowMicros() + (std::int64_t)((shim.delayMs + shim.jitterMs * random()) * 1000.0f);
+    p.size = size;
+    std::memcpy(p.data, data, size);
+}
+
+void UdpPeer::flush() {
+    // Earliest first, so datagrams only overtake each other through jitter
+    std::int64_t now = nowMicros();
+    for (;;) {
+        std::size_t next = pendingCount;
+        for (std::size_t i = 0; i < pendingCount; ++i) {
+            if (pending[i].dueMicros <= now && (next == pendingCount || pending[i].dueMicros < pending[next].dueMicros)) {
+                next = i;
+            }
+        }
+        if (next == pendingCount) {
+            return;
+        }
+        transmit(pending[next].data, pending[next].size);
+        pending[next] = pending[--pendingCount];
+    }
+}
+
+std::size_t UdpPeer::receive(std::uint8_t* buffer, std::size_t capacity) {
+    if (handle < 0) {
+        return 0;
+    }
+    for (;;) {
+        sockaddr_in from;
+        socklen_t fromSize = sizeof(from);
+        long long n = (long long)recvfrom(handle, (char*)buffer, (int)capacity, 0, (sockaddr*)&from, &fromSize);
+        if (n <= 0) {
+            return 0;
+        }
+        // Anything not from the peer is ignored
+        if (from.sin_addr.s_addr == peerAddress && from.sin_port == peerPort) {
+            return (std::size_t)n;
+        }
+    }
+}
@@ -0,0 +1,64 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Non-blocking UDP between two fixed peers, with an optional shim that
+// delays and drops outgoing datagrams so a loopback link behaves like a
+// real network. Applying the shim on both peers' sends gives a round
+// trip of twice its delay.
+
+struct LinkShim {
+    float delayMs = 0.0f;  // added to every datagram, one way
+    float jitterMs = 0.0f; // extra delay, uniform in [0, jitterMs)
+    float loss = 0.0f;     // fraction of datagrams dropped, 0 to 1
+};
+
+class UdpPeer {
+public:
+    // Datagrams are at most this large
+    static const std::size_t MAX_DATAGRAM = 512;
+
+    UdpPeer();
+    ~UdpPeer();
+    UdpPeer(const UdpPeer&) = delete;
+    UdpPeer& operator=(const UdpPeer&) = delete;
+
+    // Binds `localPort` and sends to `peer` ("host:port"); on failure
+    // returns false with `error` set
+    bool open(int localPort, const char* peer, std::string& error);
+    void close();
+
+    void setShim(const LinkShim& shim, std::uint32_t seed);
+
+    // Sends a datagram now, or queues it until the shim's delay is up;
+    // the queue is fixed-size, so a full one drops the datagram
+    void send(const std::uint8_t* data, std::size_t size);
+    // Sends queued datagrams that are due; call every loop
+    void flush();
+    // Copies the next datagram from the peer into `buffer` and returns its
+    // size, or 0 if none is waiting
+    std::size_t receive(std::uint8_t* buffer, std::size_t capacity);
+
+    long long datagramsSent = 0, bytesSent = 0, datagramsDropped = 0;
+
+private:
+    struct Pending {
+        std::int64_t dueMicros;
+        std::size_t size;
+        std::uint8_t data[MAX_DATAGRAM];
+    };
+
+    void transmit(const std::uint8_t* data, std::size_t size);
+    float random();
+
+    long long handle = -1; // socket descriptor, -1 when closed
+    std::uint32_t peerAddress = 0;
+    std::uint16_t peerPort = 0;
+    LinkShim shim;
+    std::uint32_t rng = 1;
+    std::vector<Pending> pending;
+    std::size_t pendingCount = 0;
+};
@@ -0,0 +1,134 @@
+#include "waves.h"
+
+#include <algorithm>
+#include <cstdio>
+#include <sstream>
+
+#include "world.h"
+
+static bool isLayoutRow(const std::string& line) {
+    return !line.empty() && line.find_first_not_of("o.") == std::string::npos;
+}
+
+bool compileWaves(const std::string& text, WaveSet& waves, std::string& error) {
+    WaveSet result;
+    bool haveFormation = false;
+    float delay = 0, originX = 0, originY = 0, spacingX = 0, spacingY = 0;
+    int row = 0;
+
+    std::istringstream lines(text);
+    std::string line;
+    for (int number = 1; std::getline(lines, line); ++number) {
+        line = line.substr(0, line.find('#'));
+        std::istringstream words(line);
+        std::string keyword;
+        if (!(words >> keyword)) {
+            continue;
+        }
+
+        bool ok = true;
+        if (keyword == "wave") {
+            result.waves.push_back({ (std::uint32_t)result.spawns.size(), 0, DEFAULT_WAVE_SPEED, DEFAULT_WAVE_SPEED });
+            haveFormation = false;
+        }
+        else if (result.waves.empty()) {
+            ok = false;
+        }
+        else if (keyword == "speed") {
+            WaveInfo& wave = result.waves.back();
+            ok = (bool)(words >> wave.startSpeed >> wave.endSpeed);
+        }
+        else if (keyword == "formation") {
+            ok = (bool)(words >> delay >> originX >> originY >> spacingX >> spacingY) && delay >= 0;
+            haveFormation = ok;
+            row = 0;
+        }
+        else if (isLayoutRow(keyword) && haveFormation) {
+            std::uint32_t tick = (std::uint32_t)(delay / TICK_DT + 0.5f);
+            for (std::size_t col = 0; col < keyword.size(); ++col) {
+                if (keyword[col] == 'o') {
+                    result.spawns.push_back({ tick, originX + col * spacingX, originY + row * spacingY });
+                    ++result.waves.back().spawnCount;
+                }
+            }
+            ++row;
+        }
+        else {
+            ok = false;
+        }
+
+        std::string rest;
+        if (!ok || words >> rest) {
+            error = "line " + std::to_string(number) + ": can't parse \"" + line + "\"";
+            return false;
+        }
+    }
+
+    if (result.waves.empty()) {
+        error = "no waves defined";
+        return false;
+    }
+    for (std::size_t i = 0; i < result.waves.size(); ++i) {
+        const WaveInfo& wave = result.waves[i];
+        if (wave.spawnCount == 0) {
+            error = "wave " + std::to_string(i + 1) + " has no enemies";
+            return false;
+        }
+        // Formations can be listed in any order; spawn in tick order
+        auto first = result.spawns.begin() + wave.firstSpawn;
+        std::stable_sort(first, first + wave.spawnCount,
+                         [](const WaveSpawn& a, const WaveSpawn& b) { return a.tick < b.tick; });
+        result.maxEnemies = std::max(result.maxEnemies, wave.spawnCount);
+    }
+    waves = std::move(result);
+    return true;
+}
+
+bool loadWaves(const char* path, WaveSet& waves, std::string& error) {
+    std::FILE* file = std::fopen(path, "rb");
+    if (file == nullptr) {
+        error = std::string(path) + ": can't open";
+        return false;
+    }
+    std::string text;
+    char buffer[4096];
+    std::size_t n;
+    while ((n = std::fread(buffer, 1, sizeof(buffer), file)) > 0) {
+        text.append(buffer, n);
+    }
+    std::fclose(file);
+
+    if (!compileWaves(text, waves, error)) {
+        error = std::string(path) + ": " + error;
+        return false;
+    }
+    return true;
+}
+
+const WaveSet& defaultWaves(TuningId tuning) {
+    static const WaveSet* const builtIn = [] {
+        static WaveSet waves[TUNING_COUNT];
+        for (int i = 0; i < TUNING_COUNT; ++i) {
+            std::string error;
+            compileWaves(withTuning((TuningId)i, [](auto config) { return decltype(config)::WAVES; }), waves[i],
+                         error);
+        }
+        return waves;
+    }();
+    return builtIn[(int)tuning < TUNING_COUNT ? (int)tuning : 0];
+}
+
+FileWatch::FileWatch(const char* path) : path(path) {
+    std::error_code ec;
+    lastWrite = std::filesystem::last_write_time(this->path, ec);
+}
+
+bool FileWatch::changed() {
+    std::error_code ec;
+    std::filesystem::file_time_type time = std::filesystem::last_write_time(path, ec);
+    if (ec || time == lastWrite) {
+        return false;
+    }
+    lastWrite = time;
+    return true;
+}
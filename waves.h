@@ -0,0 +1,61 @@
+#pragma once
+
+#include <cstdint>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include "tuning.h"
+
+// Enemy waves, written as text and compiled into flat spawn tables.
+//
+//     # comments run to the end of the line
+//     wave
+//     speed 100 200            # px/s with no kills, and as the last enemy falls
+//     formation 0 100 50 60 40 # delay (s), top-left x y, spacing x y
+//     oooooooo                 # one layout row: 'o' enemy, '.' gap
+//     o.o..o.o
+//
+// Waves play in order; the next starts when the current one has spawned
+// everything and been cleared. A wave's formations spawn `delay` seconds
+// after it starts, and its speed rises linearly with the kills in it.
+// A wave with no speed line keeps DEFAULT_WAVE_SPEED throughout.
+
+const float DEFAULT_WAVE_SPEED = 100.0f;
+
+struct WaveSpawn {
+    std::uint32_t tick; // ticks after the wave starts
+    float x, y;
+};
+
+struct WaveInfo {
+    std::uint32_t firstSpawn, spawnCount; // range in WaveSet::spawns
+    float startSpeed, endSpeed;
+};
+
+struct WaveSet {
+    std::vector<WaveInfo> waves;
+    std::vector<WaveSpawn> spawns; // each wave's range is in tick order
+    std::uint32_t maxEnemies = 0;  // most enemies any one wave spawns
+};
+
+// On failure `error` names the offending line and `waves` is untouched
+bool compileWaves(const std::string& text, WaveSet& waves, std::string& error);
+bool loadWaves(const char* path, WaveSet& waves, std::string& error);
+
+// A tuning's built-in waves (the original single 4x8 wave for classic);
+// used when no wave file is given
+const WaveSet& defaultWaves(TuningId tuning);
+
+// Notices when a file's modification time changes
+class FileWatch {
+public:
+    explicit FileWatch(const char* path);
+
+    // True once per change since the last call (or construction)
+    bool changed();
+
+private:
+    std::filesystem::path path;
+    std::filesystem::file_time_type lastWrite;
+};
@@ -0,0 +1,437 @@
+#include "world.h"
+
+#include <algorithm>
+
+#include "formation.h"
+#include "mask.h"
+#include "profiler.h"
+#include "waves.h"
+
+static bool intersects(float ax, float ay, float aw, float ah, float bx, float by, float bw, float bh) {
+    float left = std::max(ax, bx);
+    float top = std::max(ay, by);
+    float right = std::min(ax + aw, bx + bw);
+    float bottom = std::min(ay + ah, by + bh);
+    return left < right && top < bottom;
+}
+
+void EntityArrays::reserve(std::size_t n) {
+    x.reserve(n);
+    y.reserve(n);
+    w.reserve(n);
+    h.reserve(n);
+    alive.reserve(n);
+    capacity = n;
+}
+
+bool EntityArrays::add(float px, float py, float pw, float ph) {
+    if (full()) {
+        return false;
+    }
+    x.push_back(px);
+    y.push_back(py);
+    w.push_back(pw);
+    h.push_back(ph);
+    alive.push_back(1);
+    return true;
+}
+
+void EntityArrays::removeAt(std::size_t i) {
+    std::size_t last = x.size() - 1;
+    x[i] = x[last];
+    y[i] = y[last];
+    w[i] = w[last];
+    h[i] = h[last];
+    alive[i] = alive[last];
+    x.pop_back();
+    y.pop_back();
+    w.pop_back();
+    h.pop_back();
+    alive.pop_back();
+}
+
+void EntityArrays::clear() {
+    x.clear();
+    y.clear();
+    w.clear();
+    h.clear();
+    alive.clear();
+}
+
+int FixedTimestep::advance(float frameDt) {
+    accumulator += frameDt;
+
+    int ticks = 0;
+    while (accumulator >= TICK_DT && ticks < MAX_TICKS_PER_FRAME) {
+        accumulator -= TICK_DT;
+        ++ticks;
+    }
+    // Drop the backlog after a long stall instead of spiralling
+    if (ticks == MAX_TICKS_PER_FRAME) {
+        accumulator = 0.0f;
+    }
+    return ticks;
+}
+
+static std::uint32_t nextRandom(std::uint64_t& state) {
+    state ^= state >> 12;
+    state ^= state << 25;
+    state ^= state >> 27;
+    return (std::uint32_t)((state * 2685821657736338717ull) >> 32);
+}
+
+std::uint32_t nextRandom(World& world) {
+    return nextRandom(world.rng);
+}
+
+// In [-1, 1)
+static float randomSigned(std::uint64_t& state) {
+    return (float)nextRandom(state) * (2.0f / 4294967296.0f) - 1.0f;
+}
+
+// splitmix64's finalizer, so nearby seeds start far-apart streams; never
+// zero, which xorshift can't leave
+static std::uint64_t mixSeed(std::uint64_t x) {
+    x = (x ^ (x >> 30)) * 0xBF58476D1CE4E5B9ull;
+    x = (x ^ (x >> 27)) * 0x94D049BB133111EBull;
+    x ^= x >> 31;
+    return x != 0 ? x : WORLD_RNG_SEED;
+}
+
+const WaveSet& activeWaves(const World& world) {
+    return world.waves != nullptr ? *world.waves : defaultWaves(world.tuning);
+}
+
+static bool waveSpawned(const World& world) {
+    const WaveInfo& info = activeWaves(world).waves[world.wave];
+    return world.nextSpawn == info.firstSpawn + info.spawnCount;
+}
+
+// Adds every enemy of the current wave whose spawn time has come
+static void spawnDue(World& world) {
+    const WaveSet& waves = activeWaves(world);
+    const WaveInfo& info = waves.waves[world.wave];
+    std::uint32_t end = info.firstSpawn + info.spawnCount;
+    while (world.nextSpawn < end && waves.spawns[world.nextSpawn].tick <= world.waveTick) {
+        const WaveSpawn& spawn = waves.spawns[world.nextSpawn++];
+        world.enemies.add(spawn.x, spawn.y, world.enemyWidth, world.enemyHeight);
+    }
+}
+
+void startWave(World& world, std::uint32_t wave) {
+    const WaveSet& waves = activeWaves(world);
+    world.wave = std::min(wave, (std::uint32_t)waves.waves.size() - 1);
+    world.waveTick = 0;
+    world.nextSpawn = waves.waves[world.wave].firstSpawn;
+    world.waveKills = 0;
+    world.enemySpeed = waves.waves[world.wave].startSpeed;
+    world.enemyDirection = 1.0f;
+
+    // Only grows if a reloaded wave file needs more room
+    if (world.enemies.capacity < waves.maxEnemies) {
+        world.enemies.reserve(waves.maxEnemies);
+    }
+    world.enemies.clear();
+    world.enemyGrid.reset(world.enemies.capacity);
+}
+
+void setTuning(World& world, TuningId tuning) {
+    world.tuning = tuning;
+    withTuning(tuning, [&](auto config) {
+        typedef decltype(config) Config;
+        world.bulletCapacity = Config::BULLET_CAPACITY;
+        world.shotCapacity = Config::SHOT_CAPACITY;
+        world.debrisCapacity = Config::DEBRIS_CAPACITY;
+    });
+}
+
+void resetWorld(World& world, std::uint64_t seed) {
+    // Two ships start a third of the screen in from either side
+    if (world.players == 2) {
+        world.playerX = WINDOW_WIDTH / 3 - world.playerWidth / 2;
+        world.player2X = 2 * WINDOW_WIDTH / 3 - world.playerWidth / 2;
+    }
+    else {
+        world.playerX = WINDOW_WIDTH / 2 - world.playerWidth / 2;
+        world.player2X = 0.0f;
+    }
+    world.playerY = WINDOW_HEIGHT - world.playerHeight - 10;
+
+    world.bullets.clear();
+    world.bullets.reserve(world.bulletCapacity);
+    world.enemies.clear();
+    world.enemies.reserve(activeWaves(world).maxEnemies);
+    world.shots.reserve(world.shotCapacity, SHOT_WIDTH, SHOT_HEIGHT);
+    world.debris.reserve(world.debrisCapacity, DEBRIS_SIZE, DEBRIS_SIZE);
+
+    world.score = 0;
+    world.playerHit = false;
+    world.seed = seed;
+    world.rng = mixSeed(seed);
+    world.debrisRng = mixSeed(~seed);
+    world.shootTimer = 0.0f;
+    world.shootTimer2 = 0.0f;
+    world.tick = 0;
+    world.playerStepX = 0.0f;
+    world.player2StepX = 0.0f;
+    world.enemyStepX = 0.0f;
+    world.enemyStepY = 0.0f;
+
+    startWave(world, 0);
+    spawnDue(world);
+}
+
+template <typename Config>
+void updateBullets(EntityArrays& bullets, float dt) {
+    float* y = bullets.y.data();
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        y[i] -= Config::BULLET_SPEED * dt;
+    }
+
+    // Remove bullets that left the screen
+    for (size_t i = 0; i < bullets.size();) {
+        if (bullets.y[i] < 0) {
+            bullets.removeAt(i);
+        }
+        else {
+            ++i;
+        }
+    }
+}
+
+template <typename Config>
+void updateEnemies(World& world, float dt) {
+    EntityArrays& enemies = world.enemies;
+    world.enemyStepX = 0.0f;
+    world.enemyStepY = 0.0f;
+    if (enemies.empty()) {
+        return;
+    }
+
+    float moveDistance = world.enemySpeed * dt * world.enemyDirection;
+    float left, right;
+    translateFormation(enemies.x.data(), enemies.w.data(), enemies.size(), moveDistance, left, right);
+    world.enemyStepX = moveDistance;
+
+    // Change direction and move down when the formation reaches a screen edge
+    if (left <= 0 || right >= WINDOW_WIDTH) {
+        world.enemyDirection *= -1;
+        shiftFormation(enemies.y.data(), enemies.size(), Config::ENEMY_DROP);
+        world.enemyStepY = Config::ENEMY_DROP;
+    }
+}
+
+template <typename Config>
+int checkBulletEnemyCollisions(World& world) {
+    EntityArrays& bullets = world.bullets;
+    EntityArrays& enemies = world.enemies;
+    SpatialGrid& grid = world.enemyGrid;
+    const SpriteMask* mask = world.enemyMask;
+    int hits = 0;
+
+    // Bring the broadphase up to date with this tick's enemy positions
+    for (size_t j = 0; j < enemies.size(); ++j) {
+        grid.update((int)j, enemies.x[j], enemies.y[j]);
+    }
+
+    // Each bullet takes out the lowest-numbered live enemy it overlaps.
+    // Removal is deferred to the sweep below so indices stay stable here.
+    // The pixel mask is only consulted once the boxes overlap.
+    for (size_t i = 0; i < bullets.size(); ++i) {
+        float bx = bullets.x[i], by = bullets.y[i], bw = bullets.w[i], bh = bullets.h[i];
+        int target = -1;
+        grid.query(bx - world.enemyWidth, by - world.enemyHeight, bx + bw, by + bh, [&](int j) {
+            if ((target == -1 || j < target) &&
+                intersects(bx, by, bw, bh, enemies.x[j], enemies.y[j], enemies.w[j], enemies.h[j]) &&
+                (mask == nullptr ||
+                 maskOverlapsRect(*mask, enemies.x[j], enemies.y[j], enemies.w[j], enemies.h[j], bx, by, bw, bh))) {
+                target = j;
+            }
+        });
+
+        if (target != -1) {
+            grid.remove(target);
+            enemies.alive[target] = 0;
+            bullets.alive[i] = 0;
+            world.score += Config::SCORE_PER_KILL;
+            ++hits;
+        }
+    }
+
+    // Explosions go out in the sweep, after the hit loop, so the loop
+    // itself stays as tight as the broadphase allows
+    if (hits > 0) {
+        for (size_t i = 0; i < bullets.size();) {
+            if (!bullets.alive[i]) {
+                bullets.removeAt(i);
+            }
+            else {
+                ++i;
+            }
+        }
+        for (size_t j = 0; j < enemies.size();) {
+            if (!enemies.alive[j]) {
+                spawnExplosion<Config>(world, enemies.x[j] + enemies.w[j] / 2, enemies.y[j] + enemies.h[j] / 2);
+                int last = (int)enemies.size() - 1;
+                enemies.removeAt(j);
+                grid.rename(last, (int)j);
+            }
+            else {
+                ++j;
+            }
+        }
+    }
+    return hits;
+}
+
+template <typename Config>
+void spawnExplosion(World& world, float cx, float cy) {
+    if (world.debris.capacity == 0) {
+        return;
+    }
+    std::uint64_t& rng = world.debrisRng;
+    float speed = Config::DEBRIS_SPEED * TICK_DT;
+    for (int k = 0; k < Config::DEBRIS_PER_EXPLOSION; ++k) {
+        // Uniform over a disc; a square would show at this density
+        float dx, dy;
+        do {
+            dx = randomSigned(rng);
+            dy = randomSigned(rng);
+        } while (dx * dx + dy * dy > 1.0f);
+        std::uint16_t life = (std::uint16_t)(Config::DEBRIS_LIFE / 2 + nextRandom(rng) % (Config::DEBRIS_LIFE / 2));
+        std::uint8_t shade = (std::uint8_t)(SHADE_FLAME + nextRandom(rng) % 3);
+        world.debris.spawn(cx - DEBRIS_SIZE / 2, cy - DEBRIS_SIZE / 2, dx * speed, dy * speed, life, shade);
+    }
+}
+
+// Random enemies fire straight down; a shot lives until it leaves the screen
+template <typename Config>
+static void fireEnemyShots(World& world) {
+    if (world.enemies.empty() || world.waveTick % Config::ENEMY_FIRE_INTERVAL != Config::ENEMY_FIRE_INTERVAL - 1) {
+        return;
+    }
+    for (int k = 0; k < Config::ENEMY_VOLLEY; ++k) {
+        std::size_t j = nextRandom(world) % world.enemies.size();
+        float x = world.enemies.x[j] + world.enemies.w[j] / 2 - SHOT_WIDTH / 2;
+        float y = world.enemies.y[j] + world.enemies.h[j];
+        float vy = Config::ENEMY_SHOT_SPEED * TICK_DT;
+        float ticks = std::max(1.0f, std::min(65535.0f, (WINDOW_HEIGHT - y) / vy + 1));
+        world.shots.spawn(x, y, 0.0f, vy, (std::uint16_t)ticks, SHADE_SHOT);
+    }
+}
+
+template <typename Config>
+void updateParticles(World& world) {
+    integrateParticles(world.shots);
+    integrateParticles(world.debris);
+
+    int ships = world.players == 2 ? 2 : 1;
+    for (int s = 0; s < ships && !world.playerHit; ++s) {
+        float x = s == 0 ? world.playerX : world.player2X;
+        if (particlesOverlapRect(world.shots, x, world.playerY, world.playerWidth, world.playerHeight)) {
+            world.playerHit = true;
+            spawnExplosion<Config>(world, x + world.playerWidth / 2, world.playerY + world.playerHeight / 2);
+        }
+    }
+}
+
+Outcome checkOutcome(const World& world) {
+    if (world.playerHit) {
+        return Outcome::Lost;
+    }
+    // Won once the last wave has spawned everything and been cleared
+    if (world.enemies.empty()) {
+        bool lastWave = world.wave + 1 >= activeWaves(world).waves.size();
+        return lastWave && waveSpawned(world) ? Outcome::Won : Outcome::Playing;
+    }
+    for (size_t i = 0; i < world.enemies.size(); ++i) {
+        if (world.enemies.y[i] > WINDOW_HEIGHT - world.playerHeight) {
+            return Outcome::Lost;
+        }
+    }
+    return Outcome::Playing;
+}
+
+// Moves one ship by its input bits and fires its gun; returns how far it
+// moved. A shot is dropped while the bullet pool is exhausted.
+template <typename Config>
+static float steerShip(World& world, float& x, float& shootTimer, std::uint8_t input, TickEvents& events) {
+    float startX = x;
+    if ((input & INPUT_LEFT) && x > 0) {
+        x -= Config::PLAYER_SPEED * TICK_DT;
+    }
+    if ((input & INPUT_RIGHT) && x < WINDOW_WIDTH - world.playerWidth) {
+        x += Config::PLAYER_SPEED * TICK_DT;
+    }
+    if ((input & INPUT_FIRE) && shootTimer <= 0 &&
+        world.bullets.add(x + world.playerWidth / 2 - BULLET_WIDTH / 2, world.playerY, BULLET_WIDTH, BULLET_HEIGHT)) {
+        shootTimer = Config::SHOOT_COOLDOWN;
+        ++events.shots;
+    }
+    return x - startX;
+}
+
+template <typename Config>
+TickEvents stepWorld(World& world, std::uint8_t input) {
+    TickEvents events;
+    float dt = TICK_DT;
+    world.shootTimer -= dt;
+    world.shootTimer2 -= dt;
+
+    // Move on to the next wave once this one is cleared
+    if (world.enemies.empty() && waveSpawned(world) && world.wave + 1 < activeWaves(world).waves.size()) {
+        startWave(world, world.wave + 1);
+    }
+    spawnDue(world);
+
+    world.playerStepX = steerShip<Config>(world, world.playerX, world.shootTimer, input, events);
+    if (world.players == 2) {
+        world.player2StepX =
+            steerShip<Config>(world, world.player2X, world.shootTimer2, (std::uint8_t)(input >> INPUT_P2_SHIFT), events);
+    }
+
+    {
+        ScopedTimer timer(world.profiler, PHASE_BULLETS);
+        updateBullets<Config>(world.bullets, dt);
+    }
+    {
+        ScopedTimer timer(world.profiler, PHASE_ENEMIES);
+        updateEnemies<Config>(world, dt);
+    }
+    {
+        ScopedTimer timer(world.profiler, PHASE_PARTICLES);
+        fireEnemyShots<Config>(world);
+        updateParticles<Config>(world);
+    }
+    {
+        ScopedTimer timer(world.profiler, PHASE_COLLISIONS);
+        events.hits = checkBulletEnemyCollisions<Config>(world);
+    }
+
+    // Speed follows the wave's curve by the share of its enemies killed
+    if (events.hits > 0) {
+        const WaveInfo& info = activeWaves(world).waves[world.wave];
+        world.waveKills += events.hits;
+        world.enemySpeed = info.startSpeed + (info.endSpeed - info.startSpeed) * world.waveKills / info.spawnCount;
+    }
+
+    ++world.waveTick;
+    ++world.tick;
+    return events;
+}
+
+TickEvents stepWorld(World& world, std::uint8_t input) {
+    return withTuning(world.tuning, [&](auto config) { return stepWorld<decltype(config)>(world, input); });
+}
+
+#define INSTANTIATE_TUNING(Config)                                            \
+    template TickEvents stepWorld<Config>(World&, std::uint8_t);              \
+    template void updateBullets<Config>(EntityArrays&, float);                \
+    template void updateEnemies<Config>(World&, float);                       \
+    template int checkBulletEnemyCollisions<Config>(World&);                  \
+    template void updateParticles<Config>(World&);                            \
+    template void spawnExplosion<Config>(World&, float, float);
+
+INSTANTIATE_TUNING(ClassicTuning)
+INSTANTIATE_TUNING(DenseTuning)
+INSTANTIATE_TUNING(StressTuning)
@@ -0,0 +1,194 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "grid.h"
+#include "particles.h"
+#include "tuning.h"
+
+class FrameProfiler;
+struct WaveSet;
+struct SpriteMask;
+
+// Simulation core: no SFML graphics or audio, so it can run headless.
+// Speeds, rates and capacities come from the world's tuning (tuning.h).
+
+// Fixed simulation step
+const float TICK_DT = 1.0f / 60.0f;
+const int MAX_TICKS_PER_FRAME = 8;
+
+// Sizes used when no textures are loaded (match player.png / enemy.png)
+const float DEFAULT_PLAYER_WIDTH = 48.0f;
+const float DEFAULT_PLAYER_HEIGHT = 30.0f;
+const float DEFAULT_ENEMY_WIDTH = 50.0f;
+const float DEFAULT_ENEMY_HEIGHT = 36.0f;
+const float BULLET_WIDTH = 5.0f;
+const float BULLET_HEIGHT = 20.0f;
+
+// Broadphase cell size; must be at least the largest entity size
+const float GRID_CELL_SIZE = 64.0f;
+
+// Enemy shots, and the explosion debris thrown out when an enemy or the
+// player is hit. A shot that touches the player ends the game.
+const float SHOT_WIDTH = 4.0f;
+const float SHOT_HEIGHT = 10.0f;
+const float DEBRIS_SIZE = 3.0f;
+
+// Particle colors, picked by the renderer
+enum ParticleShade : std::uint8_t {
+    SHADE_SHOT,
+    SHADE_FLAME,
+    SHADE_EMBER,
+    SHADE_SPARK
+};
+
+// The seed of a game nobody picked one for. A game's random streams all
+// follow from its seed, so the same seed and inputs replay exactly.
+const std::uint64_t WORLD_RNG_SEED = 0x9E3779B97F4A7C15ull;
+
+// Per-tick input bits
+enum InputBits : std::uint8_t {
+    INPUT_LEFT = 1 << 0,
+    INPUT_RIGHT = 1 << 1,
+    INPUT_FIRE = 1 << 2
+};
+
+// In two-player games the second ship reads the same bits shifted up by
+// this much, so one byte still holds a whole tick's input
+const int INPUT_P2_SHIFT = 3;
+
+enum class Outcome {
+    Playing,
+    Won,
+    Lost
+};
+
+// Entities are stored as a structure of arrays so the per-tick loops
+// stream contiguous floats. Removal swaps the last entity into the hole,
+// which keeps live entities packed at the front: slots [size, capacity)
+// are the free list, and add/remove never touch the heap once reserved.
+struct EntityArrays {
+    std::vector<float> x, y, w, h;
+    std::vector<std::uint8_t> alive;
+    std::size_t capacity = 0;
+
+    std::size_t size() const { return x.size(); }
+    bool empty() const { return x.empty(); }
+    bool full() const { return x.size() >= capacity; }
+
+    // Sets the capacity to n, allocating storage for it up front
+    void reserve(std::size_t n);
+    // Returns false when the arrays are full
+    bool add(float px, float py, float pw, float ph);
+    void removeAt(std::size_t i);
+    void clear();
+};
+
+struct World {
+    TuningId tuning = TuningId::Classic;
+    // 1, or 2 for a second ship steered by the INPUT_P2_SHIFT bits; like
+    // the tuning, takes effect at the next resetWorld
+    int players = 1;
+
+    float playerX = 0, playerY = 0;
+    float playerWidth = DEFAULT_PLAYER_WIDTH, playerHeight = DEFAULT_PLAYER_HEIGHT;
+    float enemyWidth = DEFAULT_ENEMY_WIDTH, enemyHeight = DEFAULT_ENEMY_HEIGHT;
+
+    EntityArrays bullets;
+    EntityArrays enemies;
+    std::size_t bulletCapacity = ClassicTuning::BULLET_CAPACITY;
+    SpatialGrid enemyGrid{ (float)WINDOW_WIDTH, (float)WINDOW_HEIGHT, GRID_CELL_SIZE };
+
+    // The second ship, in two-player games. It is the same size as the
+    // first and shares its row, score and fate: a shot hitting either
+    // ship sets playerHit.
+    float player2X = 0, player2StepX = 0;
+    float shootTimer2 = 0.0f;
+
+    int score = 0;
+    float shootTimer = 0.0f;
+    float enemyDirection = 1.0f;
+    float enemySpeed = 0.0f; // set by each wave
+    std::uint32_t tick = 0;
+
+    // Enemy shots and explosion debris. Shots are simulation state; debris
+    // is only drawn, so it isn't saved or hashed.
+    ParticlePool shots, debris;
+    std::size_t shotCapacity = ClassicTuning::SHOT_CAPACITY, debrisCapacity = ClassicTuning::DEBRIS_CAPACITY;
+    bool playerHit = false;
+
+    // Random stream for enemy fire (xorshift64*). Debris draws from its
+    // own stream, which like the debris isn't saved or hashed, so how much
+    // debris there is never changes the game.
+    std::uint64_t rng = WORLD_RNG_SEED;
+    std::uint64_t debrisRng = WORLD_RNG_SEED;
+    std::uint64_t seed = WORLD_RNG_SEED; // what this game's streams started from
+
+    // Optional pixel mask for enemies; when set, a bullet only hits an
+    // enemy whose box it overlaps if it also covers a solid pixel
+    const SpriteMask* enemyMask = nullptr;
+
+    // Wave progress: which wave, ticks since it started, the next spawn
+    // table entry and enemies killed in it. The tables come from `waves`,
+    // or the built-in waves when that is null.
+    const WaveSet* waves = nullptr;
+    std::uint32_t wave = 0, waveTick = 0, nextSpawn = 0, waveKills = 0;
+
+    // How far the player and the formation moved during the last tick,
+    // so the renderer can interpolate between ticks
+    float playerStepX = 0, enemyStepX = 0, enemyStepY = 0;
+
+    // Optional; times the update phases when set and enabled
+    FrameProfiler* profiler = nullptr;
+};
+
+// What happened during one tick, for the audio and HUD side
+struct TickEvents {
+    int shots = 0;
+    int hits = 0;
+};
+
+// Accumulates frame time and hands out whole simulation ticks
+struct FixedTimestep {
+    float accumulator = 0.0f;
+
+    int advance(float frameDt);
+    float alpha() const { return accumulator / TICK_DT; }
+};
+
+// Switches the world to a tuning and takes its capacities; takes effect
+// at the next resetWorld
+void setTuning(World& world, TuningId tuning);
+// Starts a new game whose random streams follow from `seed`
+void resetWorld(World& world, std::uint64_t seed = WORLD_RNG_SEED);
+// Clears the playfield and restarts from `wave`, reusing entity storage
+void startWave(World& world, std::uint32_t wave);
+// The world's wave file, or its tuning's built-in waves
+const WaveSet& activeWaves(const World& world);
+// Steps with the world's tuning
+TickEvents stepWorld(World& world, std::uint8_t input);
+
+std::uint32_t nextRandom(World& world);
+
+// The tick itself, compiled once per tuning (instantiated in world.cpp
+// for ClassicTuning, DenseTuning and StressTuning). Calling these with a
+// tuning other than world.tuning is allowed; the benchmarks do.
+template <typename Config>
+TickEvents stepWorld(World& world, std::uint8_t input);
+template <typename Config>
+void updateBullets(EntityArrays& bullets, float dt);
+template <typename Config>
+void updateEnemies(World& world, float dt);
+template <typename Config>
+int checkBulletEnemyCollisions(World& world);
+// Moves shots and debris; a shot touching the player sets playerHit
+template <typename Config>
+void updateParticles(World& world);
+// Throws debris out from (cx, cy); does nothing in a world without debris
+// storage
+template <typename Config>
+void spawnExplosion(World& world, float cx, float cy);
+
+Outcome checkOutcome(const World& world);